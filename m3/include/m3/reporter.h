@@ -26,6 +26,7 @@
 #include <unordered_map>
 
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace m3 {
 
@@ -70,10 +71,30 @@ class Reporter : public tally::StatsReporter {
       std::chrono::nanoseconds buckets_lower_bound,
       std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) override;
 
+  void ReportCounter(const std::string &name, const tally::TagSet &tags,
+                     int64_t value) override;
+
+  void ReportGauge(const std::string &name, const tally::TagSet &tags,
+                   double value) override;
+
+  void ReportTimer(const std::string &name, const tally::TagSet &tags,
+                   std::chrono::nanoseconds value) override;
+
+  void ReportHistogramValueSamples(
+      const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, double buckets_lower_bound,
+      double buckets_upper_bound, uint64_t samples) override;
+
+  void ReportHistogramDurationSamples(
+      const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+      std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) override;
+
  private:
   Reporter(const std::string &host, uint16_t port,
            const std::unordered_map<std::string, std::string> &common_tags,
-           uint32_t max_queue_size, uint16_t max_packet_size);
+           uint32_t max_queue_size, uint16_t max_packet_size,
+           bool aggregated_timers);
 
   class Impl;
   std::unique_ptr<Impl> impl_;
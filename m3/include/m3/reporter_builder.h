@@ -43,6 +43,12 @@ class ReporterBuilder {
 
   ReporterBuilder &max_packet_size(uint16_t size);
 
+  // aggregated_timers sets whether the Reporter asks Scopes to aggregate timers
+  // into histograms which are reported once per interval, rather than sending
+  // every duration recorded. Aggregating bounds the number of metrics emitted
+  // per timer regardless of traffic. It is disabled by default.
+  ReporterBuilder &aggregated_timers(bool aggregated);
+
   // Build constructs the Reporter.
   std::shared_ptr<Reporter> Build();
 
@@ -52,6 +58,7 @@ class ReporterBuilder {
   std::unordered_map<std::string, std::string> common_tags_;
   uint32_t max_queue_size_;
   uint32_t max_packet_size_;
+  bool aggregated_timers_;
 };
 
 }  // namespace m3
@@ -32,9 +32,9 @@ namespace m3 {
 Reporter::Reporter(
     const std::string &host, uint16_t port,
     const std::unordered_map<std::string, std::string> &common_tags,
-    uint32_t max_queue_size, uint16_t max_packet_size)
+    uint32_t max_queue_size, uint16_t max_packet_size, bool aggregated_timers)
     : impl_(new Reporter::Impl(host, port, common_tags, max_queue_size,
-                               max_packet_size)) {}
+                               max_packet_size, aggregated_timers)) {}
 
 // Generate the default destructor here in the class file since the destructor
 // of the Impl class has now been defined.
@@ -86,4 +86,37 @@ void Reporter::ReportHistogramDurationSamples(
                                         buckets_upper_bound, samples);
 }
 
+void Reporter::ReportCounter(const std::string &name,
+                             const tally::TagSet &tags, int64_t value) {
+  impl_->ReportCounter(name, tags, value);
+}
+
+void Reporter::ReportGauge(const std::string &name, const tally::TagSet &tags,
+                           double value) {
+  impl_->ReportGauge(name, tags, value);
+}
+
+void Reporter::ReportTimer(const std::string &name, const tally::TagSet &tags,
+                           std::chrono::nanoseconds value) {
+  impl_->ReportTimer(name, tags, value);
+}
+
+void Reporter::ReportHistogramValueSamples(
+    const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+    uint64_t num_buckets, double buckets_lower_bound,
+    double buckets_upper_bound, uint64_t samples) {
+  impl_->ReportHistogramValueSamples(name, tags, bucket_id, num_buckets,
+                                     buckets_lower_bound, buckets_upper_bound,
+                                     samples);
+}
+
+void Reporter::ReportHistogramDurationSamples(
+    const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+    uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+    std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {
+  impl_->ReportHistogramDurationSamples(name, tags, bucket_id, num_buckets,
+                                        buckets_lower_bound,
+                                        buckets_upper_bound, samples);
+}
+
 }  // namespace m3
@@ -26,6 +26,7 @@ namespace {
 constexpr uint32_t DEFAULT_MAX_QUEUE_SIZE = 1024;
 constexpr uint16_t DEFAULT_MAX_PACKET_SIZE = 1440;
 constexpr uint16_t DEFAULT_PORT = 9052;
+constexpr bool DEFAULT_AGGREGATED_TIMERS = false;
 const std::string DEFAULT_HOST = "127.0.0.1";
 const std::unordered_map<std::string, std::string> DEFAULT_COMMON_TAGS =
     std::unordered_map<std::string, std::string>{};
@@ -36,7 +37,8 @@ ReporterBuilder::ReporterBuilder()
       port_(DEFAULT_PORT),
       common_tags_(DEFAULT_COMMON_TAGS),
       max_queue_size_(DEFAULT_MAX_QUEUE_SIZE),
-      max_packet_size_(DEFAULT_MAX_PACKET_SIZE) {}
+      max_packet_size_(DEFAULT_MAX_PACKET_SIZE),
+      aggregated_timers_(DEFAULT_AGGREGATED_TIMERS) {}
 
 ReporterBuilder &ReporterBuilder::host(const std::string &host) {
   host_ = host;
@@ -64,9 +66,15 @@ ReporterBuilder &ReporterBuilder::max_packet_size(uint16_t size) {
   return *this;
 }
 
+ReporterBuilder &ReporterBuilder::aggregated_timers(bool aggregated) {
+  aggregated_timers_ = aggregated;
+  return *this;
+}
+
 std::shared_ptr<Reporter> ReporterBuilder::Build() {
-  return std::shared_ptr<Reporter>(new Reporter(
-      host_, port_, common_tags_, max_queue_size_, max_packet_size_));
+  return std::shared_ptr<Reporter>(
+      new Reporter(host_, port_, common_tags_, max_queue_size_,
+                   max_packet_size_, aggregated_timers_));
 }
 
 }  // namespace m3
@@ -42,16 +42,20 @@ namespace m3 {
 namespace {
 std::string HISTOGRAM_BUCKET_NAME = "bucket";
 std::string HISTOGRAM_BUCKET_ID_NAME = "bucketid";
+
+// The maximum number of TagSets whose converted tags are cached.
+const std::size_t MAX_CONVERTED_TAGS = 4096;
 }  // namespace
 
 Reporter::Impl::Impl(
     const std::string &host, uint16_t port,
     const std::unordered_map<std::string, std::string> &common_tags,
-    uint32_t max_queue_size, uint16_t max_packet_size)
+    uint32_t max_queue_size, uint16_t max_packet_size, bool aggregated_timers)
     : common_tags_(ConvertTags(common_tags)),
       max_queue_size_(max_queue_size),
       // Reserve 20% of the packet size for encoding overhead.
       max_packet_size_((max_packet_size / 5) * 4),
+      aggregated_timers_(aggregated_timers),
       run_(true) {
   emission_batch_.__set_commonTags(common_tags_);
 
@@ -81,9 +85,13 @@ Reporter::Impl::~Impl() {
 }
 
 std::unique_ptr<tally::Capabilities> Reporter::Impl::Capabilities() {
-  return std::unique_ptr<tally::Capabilities>(new tally::CapableOf(true, true));
+  return std::unique_ptr<tally::Capabilities>(
+      new tally::CapableOf(true, true, aggregated_timers_));
 }
 
+// Tags reported as maps are converted on every report, since unlike TagSets
+// they are not shared between reports and would only churn the cache of
+// converted tags.
 void Reporter::Impl::ReportCounter(
     const std::string &name,
     const std::unordered_map<std::string, std::string> &tags, int64_t value) {
@@ -114,8 +122,60 @@ void Reporter::Impl::ReportHistogramValueSamples(
     const std::unordered_map<std::string, std::string> &tags,
     uint64_t bucket_id, uint64_t num_buckets, double buckets_lower_bound,
     double buckets_upper_bound, uint64_t samples) {
+  ReportValueSamples(name, ConvertTags(tags), bucket_id, num_buckets,
+                     buckets_lower_bound, buckets_upper_bound, samples);
+}
+
+void Reporter::Impl::ReportHistogramDurationSamples(
+    const std::string &name,
+    const std::unordered_map<std::string, std::string> &tags,
+    uint64_t bucket_id, uint64_t num_buckets,
+    std::chrono::nanoseconds buckets_lower_bound,
+    std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {
+  ReportDurationSamples(name, ConvertTags(tags), bucket_id, num_buckets,
+                        buckets_lower_bound, buckets_upper_bound, samples);
+}
+
+void Reporter::Impl::ReportCounter(const std::string &name,
+                                   const tally::TagSet &tags, int64_t value) {
+  auto counter = CreateCounter(value);
+  ReportMetric(name, *ConvertedTags(tags), counter);
+}
+
+void Reporter::Impl::ReportGauge(const std::string &name,
+                                 const tally::TagSet &tags, double value) {
+  auto gauge = CreateGauge(value);
+  ReportMetric(name, *ConvertedTags(tags), gauge);
+}
+
+void Reporter::Impl::ReportTimer(const std::string &name,
+                                 const tally::TagSet &tags,
+                                 std::chrono::nanoseconds value) {
+  auto timer = CreateTimer(value);
+  ReportMetric(name, *ConvertedTags(tags), timer);
+}
+
+void Reporter::Impl::ReportHistogramValueSamples(
+    const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+    uint64_t num_buckets, double buckets_lower_bound,
+    double buckets_upper_bound, uint64_t samples) {
+  ReportValueSamples(name, *ConvertedTags(tags), bucket_id, num_buckets,
+                     buckets_lower_bound, buckets_upper_bound, samples);
+}
+
+void Reporter::Impl::ReportHistogramDurationSamples(
+    const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+    uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+    std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {
+  ReportDurationSamples(name, *ConvertedTags(tags), bucket_id, num_buckets,
+                        buckets_lower_bound, buckets_upper_bound, samples);
+}
+
+void Reporter::Impl::ReportValueSamples(
+    const std::string &name, std::set<thrift::MetricTag> metric_tags,
+    uint64_t bucket_id, uint64_t num_buckets, double buckets_lower_bound,
+    double buckets_upper_bound, uint64_t samples) {
   auto counter = CreateCounter(samples);
-  auto metric_tags = ConvertTags(tags);
 
   // Add tag for bucket.
   std::ostringstream bucket_stream;
@@ -137,14 +197,12 @@ void Reporter::Impl::ReportHistogramValueSamples(
   ReportMetric(name, metric_tags, counter);
 }
 
-void Reporter::Impl::ReportHistogramDurationSamples(
-    const std::string &name,
-    const std::unordered_map<std::string, std::string> &tags,
+void Reporter::Impl::ReportDurationSamples(
+    const std::string &name, std::set<thrift::MetricTag> metric_tags,
     uint64_t bucket_id, uint64_t num_buckets,
     std::chrono::nanoseconds buckets_lower_bound,
     std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {
   auto counter = CreateCounter(samples);
-  auto metric_tags = ConvertTags(tags);
 
   // Add tag for bucket.
   std::ostringstream bucket_stream;
@@ -219,6 +277,42 @@ std::set<thrift::MetricTag> Reporter::Impl::ConvertTags(
   return metric_tags;
 }
 
+std::set<thrift::MetricTag> Reporter::Impl::ConvertTags(
+    const tally::TagSet &tags) {
+  std::set<thrift::MetricTag> metric_tags;
+  for (auto const &entry : tags) {
+    thrift::MetricTag tag;
+    tag.__set_tagName(entry.first);
+    tag.__set_tagValue(entry.second);
+    metric_tags.insert(metric_tags.end(), tag);
+  }
+  return metric_tags;
+}
+
+std::shared_ptr<const std::set<thrift::MetricTag>>
+Reporter::Impl::ConvertedTags(const tally::TagSet &tags) {
+  std::lock_guard<std::mutex> lock(converted_tags_mutex_);
+  auto entry = converted_tags_.find(&tags);
+  if (entry != converted_tags_.end()) {
+    // Move the entry to the front of the list as the most recently used.
+    converted_tags_lru_.splice(converted_tags_lru_.begin(),
+                               converted_tags_lru_, entry->second);
+    return entry->second->second;
+  }
+
+  converted_tags_lru_.emplace_front(
+      tags,
+      std::make_shared<std::set<thrift::MetricTag>>(ConvertTags(tags)));
+  converted_tags_.emplace(&converted_tags_lru_.front().first,
+                          converted_tags_lru_.begin());
+
+  if (converted_tags_lru_.size() > MAX_CONVERTED_TAGS) {
+    converted_tags_.erase(&converted_tags_lru_.back().first);
+    converted_tags_lru_.pop_back();
+  }
+  return converted_tags_lru_.front().second;
+}
+
 std::string Reporter::Impl::ValueBucketString(double bucket_bound) {
   if (bucket_bound == std::numeric_limits<double>::max()) {
     return "infinity";
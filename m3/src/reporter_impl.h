@@ -22,6 +22,8 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -38,6 +40,7 @@
 #include "m3/thrift/m3_types.h"
 #include "m3/udp_transport.h"
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 using apache::thrift::transport::TTransport;
 
@@ -47,7 +50,8 @@ class Reporter::Impl : public tally::StatsReporter {
  public:
   Impl(const std::string &host, uint16_t port,
        const std::unordered_map<std::string, std::string> &common_tags,
-       uint32_t max_queue_size, uint16_t max_packet_size);
+       uint32_t max_queue_size, uint16_t max_packet_size,
+       bool aggregated_timers);
 
   ~Impl();
 
@@ -86,6 +90,25 @@ class Reporter::Impl : public tally::StatsReporter {
       std::chrono::nanoseconds buckets_lower_bound,
       std::chrono::nanoseconds buckets_upper_bound, uint64_t samples);
 
+  void ReportCounter(const std::string &name, const tally::TagSet &tags,
+                     int64_t value);
+
+  void ReportGauge(const std::string &name, const tally::TagSet &tags,
+                   double value);
+
+  void ReportTimer(const std::string &name, const tally::TagSet &tags,
+                   std::chrono::nanoseconds value);
+
+  void ReportHistogramValueSamples(
+      const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, double buckets_lower_bound,
+      double buckets_upper_bound, uint64_t samples);
+
+  void ReportHistogramDurationSamples(
+      const std::string &name, const tally::TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+      std::chrono::nanoseconds buckets_upper_bound, uint64_t samples);
+
  private:
   // Run implements the logic of the Reporter, pulling metrics of its queue and
   // emitting them.
@@ -109,9 +132,33 @@ class Reporter::Impl : public tally::StatsReporter {
 
   thrift::MetricValue CreateTimer(std::chrono::nanoseconds value);
 
+  // ReportValueSamples and ReportDurationSamples report histogram samples with
+  // the provided metric tags, to which the bucket tags are added.
+  void ReportValueSamples(const std::string &name,
+                          std::set<thrift::MetricTag> metric_tags,
+                          uint64_t bucket_id, uint64_t num_buckets,
+                          double buckets_lower_bound,
+                          double buckets_upper_bound, uint64_t samples);
+
+  void ReportDurationSamples(const std::string &name,
+                             std::set<thrift::MetricTag> metric_tags,
+                             uint64_t bucket_id, uint64_t num_buckets,
+                             std::chrono::nanoseconds buckets_lower_bound,
+                             std::chrono::nanoseconds buckets_upper_bound,
+                             uint64_t samples);
+
   std::set<thrift::MetricTag> ConvertTags(
       const std::unordered_map<std::string, std::string> &tags);
 
+  std::set<thrift::MetricTag> ConvertTags(const tally::TagSet &tags);
+
+  // ConvertedTags returns the provided tags converted into metric tags. The
+  // tags of the most recently reported TagSets are cached so that they are
+  // not converted on every report, and the least recently used are evicted
+  // once the cache is full.
+  std::shared_ptr<const std::set<thrift::MetricTag>> ConvertedTags(
+      const tally::TagSet &tags);
+
   std::string ValueBucketString(double bucket_bound);
 
   std::string DurationBucketString(std::chrono::nanoseconds bucket_bound);
@@ -123,6 +170,7 @@ class Reporter::Impl : public tally::StatsReporter {
   const std::set<thrift::MetricTag> common_tags_;
   const uint32_t max_queue_size_;
   const uint16_t max_packet_size_;
+  const bool aggregated_timers_;
 
   std::condition_variable bg_thread_cv_;
   std::thread thread_;
@@ -135,6 +183,32 @@ class Reporter::Impl : public tally::StatsReporter {
   thrift::MetricBatch emission_batch_;
   std::unique_ptr<thrift::M3Client> emission_client_;
 
+  // TagSetPtrHash and TagSetPtrEqual hash and compare the TagSets which the
+  // cache of converted tags is keyed by, rather than their addresses.
+  struct TagSetPtrHash {
+    std::size_t operator()(const tally::TagSet *tags) const noexcept {
+      return static_cast<std::size_t>(tags->hash());
+    }
+  };
+
+  struct TagSetPtrEqual {
+    bool operator()(const tally::TagSet *a, const tally::TagSet *b) const {
+      return *a == *b;
+    }
+  };
+
+  // The cached converted tags, ordered from the most to the least recently
+  // used, and indexed by the TagSets held in the list.
+  using ConvertedTagsList =
+      std::list<std::pair<tally::TagSet,
+                          std::shared_ptr<const std::set<thrift::MetricTag>>>>;
+
+  std::mutex converted_tags_mutex_;
+  ConvertedTagsList converted_tags_lru_;
+  std::unordered_map<const tally::TagSet *, ConvertedTagsList::iterator,
+                     TagSetPtrHash, TagSetPtrEqual>
+      converted_tags_;
+
   std::mutex queue_mutex_;
   std::queue<thrift::Metric> queue_;
 };
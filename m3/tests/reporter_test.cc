@@ -41,6 +41,7 @@
 #include "m3/udp_transport.h"
 #include "mock_handler.h"
 #include "mock_server.h"
+#include "tally/tag_set.h"
 
 class ReporterTest : public ::testing::Test {
  protected:
@@ -100,6 +101,39 @@ TEST_F(ReporterTest, ReportCounter) {
   EXPECT_EQ(value, metric_value.count.i64Value);
 }
 
+TEST_F(ReporterTest, ReportCounterWithTagSet) {
+  std::string name("foo");
+  auto tags = tally::TagSet::Intern({{"a", "1"}, {"b", "2"}});
+  int64_t value = 1;
+
+  std::set<m3::thrift::MetricTag> expected_tags;
+  for (auto const &entry : *tags) {
+    m3::thrift::MetricTag tag;
+    tag.__set_tagName(entry.first);
+    tag.__set_tagValue(entry.second);
+    expected_tags.insert(tag);
+  }
+
+  reporter_->ReportCounter(name, *tags, value);
+  reporter_->Flush();
+
+  while (true) {
+    if (!server_->empty()) {
+      break;
+    }
+    reporter_->Flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  auto batch = server_->getBatch();
+  auto metric = batch.metrics[0];
+  EXPECT_EQ(name, metric.name);
+  EXPECT_EQ(expected_tags, metric.tags);
+  auto metric_value = metric.metricValue;
+  EXPECT_TRUE(metric_value.__isset.count);
+  EXPECT_EQ(value, metric_value.count.i64Value);
+}
+
 TEST_F(ReporterTest, ReportGauge) {
   std::string name("foo");
   std::unordered_map<std::string, std::string> tags({{"a", "1"}});
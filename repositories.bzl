@@ -10,6 +10,15 @@ def load_com_google_googletest():
         ],
     )
 
+def load_com_github_google_benchmark():
+    http_archive(
+        name = "com_github_google_benchmark",
+        strip_prefix = "benchmark-1.7.1",
+        urls = [
+            "https://github.com/google/benchmark/archive/v1.7.1.zip",
+        ],
+    )
+
 def load_com_github_nelhage_rules_boost():
     git_repository(
         name = "com_github_nelhage_rules_boost",
@@ -117,5 +126,6 @@ def load_org_apache_thrift():
 
 def tally_cpp_repositories():
     load_com_google_googletest()
+    load_com_github_google_benchmark()
     load_com_github_nelhage_rules_boost()
     load_org_apache_thrift()
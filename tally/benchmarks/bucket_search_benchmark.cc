@@ -0,0 +1,106 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "tally/src/bucket_search.h"
+
+namespace {
+
+// Bounds returns `num` latency-like bounds which grow irregularly so that no
+// closed form describes them.
+std::vector<double> Bounds(int64_t num) {
+  std::vector<double> bounds;
+  double bound = 1;
+  for (int64_t i = 0; i < num; i++) {
+    bounds.push_back(bound);
+    bound += 1 + bound * (i % 3 == 0 ? 0.2 : 0.05);
+  }
+  return bounds;
+}
+
+// Values returns a fixed sequence of pseudo-random values spread uniformly
+// across the buckets of `bounds`, so that a binary search cannot predict its
+// branches.
+std::vector<double> Values(const std::vector<double> &bounds) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<std::size_t> distribution(0,
+                                                          bounds.size() - 1);
+  std::vector<double> values(1024);
+  for (auto &value : values) {
+    value = bounds[distribution(generator)] + 0.5;
+  }
+  return values;
+}
+
+// The argument of each benchmark is the number of bounds.
+void BM_BucketSearchBinary(benchmark::State &state) {
+  auto const bounds = Bounds(state.range(0));
+  auto const values = Values(bounds);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    auto const value = values[i++ & (values.size() - 1)];
+    benchmark::DoNotOptimize(
+        std::upper_bound(bounds.begin(), bounds.end(), value));
+  }
+}
+
+void Search(benchmark::State &state,
+            tally::BucketSearch::Instructions instructions) {
+  if (!tally::BucketSearch::Supports(instructions)) {
+    state.SkipWithError("Instructions are not supported by this CPU");
+    return;
+  }
+
+  auto const bounds = Bounds(state.range(0));
+  auto const values = Values(bounds);
+  tally::BucketSearch search(bounds, instructions);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(search.Find(values[i++ & (values.size() - 1)]));
+  }
+}
+
+void BM_BucketSearchScalar(benchmark::State &state) {
+  Search(state, tally::BucketSearch::Instructions::Scalar);
+}
+
+void BM_BucketSearchSSE2(benchmark::State &state) {
+  Search(state, tally::BucketSearch::Instructions::SSE2);
+}
+
+void BM_BucketSearchAVX2(benchmark::State &state) {
+  Search(state, tally::BucketSearch::Instructions::AVX2);
+}
+
+}  // namespace
+
+BENCHMARK(BM_BucketSearchBinary)->RangeMultiplier(2)->Range(16, 1024);
+
+BENCHMARK(BM_BucketSearchScalar)->RangeMultiplier(2)->Range(16, 1024);
+
+BENCHMARK(BM_BucketSearchSSE2)->RangeMultiplier(2)->Range(16, 1024);
+
+BENCHMARK(BM_BucketSearchAVX2)->RangeMultiplier(2)->Range(16, 1024);
@@ -0,0 +1,47 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+
+#include "tally/clock.h"
+
+namespace {
+
+// Measures reading the current instant. The argument is the Clock::Source,
+// and the benchmark is skipped if the source is not supported.
+void BM_ClockNow(benchmark::State &state) {
+  auto const source = static_cast<tally::Clock::Source>(state.range(0));
+  if (!tally::Clock::Use(source)) {
+    state.SkipWithError("unsupported clock source");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tally::Clock::Now());
+  }
+  tally::Clock::Use(tally::Clock::Source::Steady);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ClockNow)
+    ->Arg(static_cast<int64_t>(tally::Clock::Source::Steady))
+    ->Arg(static_cast<int64_t>(tally::Clock::Source::TSC));
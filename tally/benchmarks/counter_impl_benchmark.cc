@@ -0,0 +1,71 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <memory>
+
+#include "benchmark/benchmark.h"
+
+#include "tally/src/counter_impl.h"
+#include "tally/src/local_counter_impl.h"
+
+namespace {
+
+std::shared_ptr<tally::CounterImpl> counter;
+
+// Measures the throughput of incrementing a single counter from a growing
+// number of threads. The argument is the number of stripes of the counter.
+void BM_CounterIncContended(benchmark::State &state) {
+  if (state.thread_index() == 0) {
+    counter.reset(new tally::CounterImpl(state.range(0)));
+  }
+  for (auto _ : state) {
+    counter->Inc();
+  }
+  if (state.thread_index() == 0) {
+    benchmark::DoNotOptimize(counter->Value());
+  }
+}
+
+// Measures the throughput of incrementing a counter through thread-local
+// handles from a growing number of threads.
+void BM_LocalCounterInc(benchmark::State &state) {
+  if (state.thread_index() == 0) {
+    counter.reset(new tally::CounterImpl());
+  }
+  {
+    tally::LocalCounterImpl local(counter);
+    for (auto _ : state) {
+      local.Inc();
+    }
+  }
+  if (state.thread_index() == 0) {
+    benchmark::DoNotOptimize(counter->Value());
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_CounterIncContended)
+    ->Arg(1)
+    ->Arg(64)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK(BM_LocalCounterInc)->ThreadRange(1, 64)->UseRealTime();
@@ -0,0 +1,215 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "tally/buckets.h"
+#include "tally/lap_stopwatch.h"
+#include "tally/scoped_stopwatch.h"
+#include "tally/src/histogram_impl.h"
+#include "tally/src/sketch_impl.h"
+
+namespace {
+
+std::shared_ptr<tally::HistogramImpl> histogram;
+
+// Values returns a fixed sequence of pseudo-random values spread across the
+// range [0, max).
+std::vector<double> Values(double max) {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> distribution(0, max);
+  std::vector<double> values(1024);
+  for (auto &value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+void RecordValues(benchmark::State &state, const tally::Buckets &buckets,
+                  double max) {
+  auto histogram = tally::HistogramImpl::New(buckets);
+  auto const values = Values(max);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    histogram->Record(values[i++ & (values.size() - 1)]);
+  }
+}
+
+// The argument of each benchmark is the number of buckets.
+void BM_HistogramRecordLinearValues(benchmark::State &state) {
+  auto const num = static_cast<uint64_t>(state.range(0));
+  RecordValues(state, tally::Buckets::LinearValues(0, 1, num), num);
+}
+
+void BM_HistogramRecordExponentialValues(benchmark::State &state) {
+  auto const num = static_cast<uint64_t>(state.range(0));
+  auto const buckets = tally::Buckets::ExponentialValues(1, 1.1, num);
+  RecordValues(state, buckets, *std::next(buckets.begin(), num - 1));
+}
+
+void BM_HistogramRecordExponentialDurations(benchmark::State &state) {
+  auto const num = static_cast<uint64_t>(state.range(0));
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialDurations(std::chrono::nanoseconds(1000), 2,
+                                           num));
+  auto const values = Values(1000.0 * (uint64_t(1) << (num < 40 ? num : 40)));
+  std::size_t i = 0;
+  for (auto _ : state) {
+    histogram->Record(std::chrono::nanoseconds(
+        static_cast<int64_t>(values[i++ & (values.size() - 1)])));
+  }
+}
+
+// Measures recording into a sketch, whose cost is independent of the number of
+// buckets, over the same range as the exponential histograms above.
+void BM_SketchRecordValues(benchmark::State &state) {
+  auto sketch =
+      tally::SketchImpl::New("foo", tally::Buckets::Kind::Values, 0.01, ".");
+  auto const values = Values(1e6);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    sketch->Record(values[i++ & (values.size() - 1)]);
+  }
+}
+
+// The argument of each batch benchmark is the number of values in the batch,
+// which are recorded into 64 exponential duration buckets.
+void BM_HistogramRecordBatchOneByOne(benchmark::State &state) {
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialValues(1000, 1.2, 64));
+  auto const values = Values(1e9);
+  auto const num = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < num; i++) {
+      histogram->Record(values[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_HistogramRecordBatchMany(benchmark::State &state) {
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialValues(1000, 1.2, 64));
+  auto const values = Values(1e9);
+  auto const num = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    histogram->RecordMany(values.data(), num);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Measures the throughput of recording into the same few buckets of a single
+// histogram from a growing number of threads. The argument is the number of
+// shards of the histogram.
+void BM_HistogramRecordContended(benchmark::State &state) {
+  if (state.thread_index() == 0) {
+    histogram = tally::HistogramImpl::New(
+        tally::Buckets::LinearValues(0, 1, 64), nullptr, state.range(0));
+  }
+  auto const values = Values(4);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    histogram->Record(values[i++ & (values.size() - 1)]);
+  }
+}
+
+// Measures timing an empty section into a histogram with a Stopwatch, which
+// shares ownership of the histogram, and with a ScopedStopwatch, which does
+// not.
+void BM_HistogramStopwatch(benchmark::State &state) {
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialDurations(std::chrono::nanoseconds(10), 2,
+                                           24));
+  for (auto _ : state) {
+    auto stopwatch = histogram->Start();
+    stopwatch.Stop();
+  }
+}
+
+void BM_HistogramScopedStopwatch(benchmark::State &state) {
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialDurations(std::chrono::nanoseconds(10), 2,
+                                           24));
+  for (auto _ : state) {
+    tally::ScopedStopwatch stopwatch(*histogram);
+  }
+}
+
+// Measures timing four consecutive empty phases into histograms with a
+// ScopedStopwatch per phase and with a single LapStopwatch.
+void BM_HistogramScopedStopwatchPhases(benchmark::State &state) {
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialDurations(std::chrono::nanoseconds(10), 2,
+                                           24));
+  for (auto _ : state) {
+    for (int phase = 0; phase < 4; phase++) {
+      tally::ScopedStopwatch stopwatch(*histogram);
+    }
+  }
+}
+
+void BM_HistogramLapStopwatchPhases(benchmark::State &state) {
+  auto histogram = tally::HistogramImpl::New(
+      tally::Buckets::ExponentialDurations(std::chrono::nanoseconds(10), 2,
+                                           24));
+  for (auto _ : state) {
+    tally::LapStopwatch stopwatch;
+    for (int phase = 0; phase < 4; phase++) {
+      stopwatch.Lap(*histogram);
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_HistogramRecordLinearValues)->RangeMultiplier(2)->Range(8, 256);
+
+BENCHMARK(BM_HistogramRecordExponentialValues)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+
+BENCHMARK(BM_HistogramRecordExponentialDurations)->DenseRange(8, 40, 16);
+
+BENCHMARK(BM_SketchRecordValues);
+
+BENCHMARK(BM_HistogramRecordBatchOneByOne)->RangeMultiplier(8)->Range(8, 1024);
+
+BENCHMARK(BM_HistogramRecordBatchMany)->RangeMultiplier(8)->Range(8, 1024);
+
+BENCHMARK(BM_HistogramRecordContended)
+    ->Arg(1)
+    ->Arg(64)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK(BM_HistogramStopwatch);
+
+BENCHMARK(BM_HistogramScopedStopwatch);
+
+BENCHMARK(BM_HistogramScopedStopwatchPhases);
+
+BENCHMARK(BM_HistogramLapStopwatchPhases);
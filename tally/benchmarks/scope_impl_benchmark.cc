@@ -0,0 +1,343 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "tally/buckets.h"
+#include "tally/scope.h"
+#include "tally/scope_builder.h"
+#include "tally/src/capable_of.h"
+#include "tally/src/scope_impl.h"
+#include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
+#include "tally/timer.h"
+
+namespace tally {
+
+// ScopeImplPeer reports a ScopeImpl on demand, which it otherwise only does
+// from its reporting thread.
+class ScopeImplPeer {
+ public:
+  static void Report(ScopeImpl *scope) { scope->Report(); }
+};
+
+}  // namespace tally
+
+namespace {
+
+const std::unique_ptr<tally::Scope> scope = tally::ScopeBuilder().Build();
+
+const tally::Buckets buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+
+// Each of the following benchmarks has every thread update a distinct metric
+// created by the same Scope. Since the metrics are unrelated any slowdown as
+// threads are added is caused by false sharing between them.
+void BM_ScopeCounterIncPerThread(benchmark::State &state) {
+  auto counter =
+      scope->Counter("counter" + std::to_string(state.thread_index()));
+  for (auto _ : state) {
+    counter->Inc();
+  }
+}
+
+// Measures looking up and incrementing an existing Counter by name, as request
+// handlers commonly do, from a growing number of threads.
+void BM_ScopeCounterLookup(benchmark::State &state) {
+  std::string const name("requests");
+  scope->Counter(name);
+  for (auto _ : state) {
+    scope->Counter(name)->Inc();
+  }
+}
+
+// Measures the same lookup by a string literal, which is too long to be stored
+// inline in a std::string.
+void BM_ScopeCounterLookupLiteral(benchmark::State &state) {
+  scope->Counter("http.server.requests");
+  for (auto _ : state) {
+    scope->Counter("http.server.requests")->Inc();
+  }
+}
+
+// Measures resolving an existing subscope by name and by tags, as request
+// handlers commonly do before looking up their metrics.
+void BM_ScopeSubScope(benchmark::State &state) {
+  std::string const name("http");
+  scope->SubScope(name);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(scope->SubScope(name));
+  }
+}
+
+void BM_ScopeTagged(benchmark::State &state) {
+  std::unordered_map<std::string, std::string> const tags(
+      {{"endpoint", "/users"}, {"method", "GET"}, {"status", "200"}});
+  scope->Tagged(tags);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(scope->Tagged(tags));
+  }
+}
+
+void BM_ScopeGaugeUpdatePerThread(benchmark::State &state) {
+  auto gauge = scope->Gauge("gauge" + std::to_string(state.thread_index()));
+  double value = 0;
+  for (auto _ : state) {
+    gauge->Update(value++);
+  }
+}
+
+void BM_ScopeHistogramRecordPerThread(benchmark::State &state) {
+  auto histogram = scope->Histogram(
+      "histogram" + std::to_string(state.thread_index()), buckets);
+  for (auto _ : state) {
+    histogram->Record(2.5);
+  }
+}
+
+// Measures reporting a Scope whose counters were all incremented during the
+// interval. The argument is the number of counters.
+void BM_ScopeReport(benchmark::State &state) {
+  tally::ScopeImpl report_scope(
+      "service", ".", tally::TagSet::Intern({{"env", "production"}}),
+      std::chrono::seconds(0), nullptr, 1, 1, tally::Timer::Mode::Immediate, 1,
+      nullptr);
+  std::vector<std::shared_ptr<tally::Counter>> counters;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    counters.push_back(report_scope.Counter("counter" + std::to_string(i)));
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (auto const &counter : counters) {
+      counter->Inc();
+    }
+    state.ResumeTiming();
+    tally::ScopeImplPeer::Report(&report_scope);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// ConvertingStatsReporter approximates the per-metric cost of a reporter which
+// converts the tags of each metric into a sorted set of its own, as the M3
+// reporter does. If `cached` it converts each TagSet once and reuses the
+// conversion, otherwise it converts the tags of every metric it is passed.
+class ConvertingStatsReporter : public tally::StatsReporter {
+ public:
+  explicit ConvertingStatsReporter(bool cached) : cached_(cached) {}
+
+  std::unique_ptr<tally::Capabilities> Capabilities() {
+    return std::unique_ptr<tally::Capabilities>(
+        new tally::CapableOf(true, true, false));
+  }
+
+  void Flush() {}
+
+  void ReportCounter(const std::string &,
+                     const std::unordered_map<std::string, std::string> &tags,
+                     int64_t) {
+    benchmark::DoNotOptimize(Convert(tags));
+  }
+
+  void ReportCounter(const std::string &name, const tally::TagSet &tags,
+                     int64_t value) {
+    if (!cached_) {
+      ReportCounter(name, tags.AsMap(), value);
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = converted_.find(tags);
+    if (entry == converted_.end()) {
+      entry = converted_.emplace(tags, Convert(tags.AsMap())).first;
+    }
+    benchmark::DoNotOptimize(entry->second);
+  }
+
+  void ReportGauge(const std::string &,
+                   const std::unordered_map<std::string, std::string> &,
+                   double) {}
+
+  void ReportTimer(const std::string &,
+                   const std::unordered_map<std::string, std::string> &,
+                   std::chrono::nanoseconds) {}
+
+  void ReportHistogramValueSamples(
+      const std::string &, const std::unordered_map<std::string, std::string> &,
+      uint64_t, uint64_t, double, double, uint64_t) {}
+
+  void ReportHistogramDurationSamples(
+      const std::string &, const std::unordered_map<std::string, std::string> &,
+      uint64_t, uint64_t, std::chrono::nanoseconds, std::chrono::nanoseconds,
+      uint64_t) {}
+
+ private:
+  using Converted = std::set<std::pair<std::string, std::string>>;
+
+  static Converted Convert(
+      const std::unordered_map<std::string, std::string> &tags) {
+    return Converted(tags.begin(), tags.end());
+  }
+
+  const bool cached_;
+  std::mutex mutex_;
+  std::unordered_map<tally::TagSet, Converted, tally::TagSet::Hasher>
+      converted_;
+};
+
+// Measures reporting counters with four tags to a reporter which converts
+// their tags. The argument is whether the reporter caches its conversions.
+void BM_ScopeReportConvertingTags(benchmark::State &state) {
+  tally::ScopeImpl report_scope(
+      "service", ".",
+      tally::TagSet::Intern({{"env", "production"},
+                             {"region", "us-east-1"},
+                             {"endpoint", "/users"},
+                             {"method", "GET"}}),
+      std::chrono::seconds(0),
+      std::make_shared<ConvertingStatsReporter>(state.range(0) != 0), 1, 1,
+      tally::Timer::Mode::Immediate, 1, nullptr);
+  std::vector<std::shared_ptr<tally::Counter>> counters;
+  for (int64_t i = 0; i < 100; i++) {
+    counters.push_back(report_scope.Counter("counter" + std::to_string(i)));
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (auto const &counter : counters) {
+      counter->Inc();
+    }
+    state.ResumeTiming();
+    tally::ScopeImplPeer::Report(&report_scope);
+  }
+  state.SetItemsProcessed(state.iterations() * counters.size());
+}
+
+// QueueingStatsReporter approximates the per-metric cost of a real reporter by
+// copying each timer's name and tags into a queue under a mutex, as a reporter
+// which sends metrics in the background would.
+class QueueingStatsReporter : public tally::StatsReporter {
+ public:
+  std::unique_ptr<tally::Capabilities> Capabilities() {
+    return std::unique_ptr<tally::Capabilities>(
+        new tally::CapableOf(true, false, false));
+  }
+
+  void Flush() {}
+
+  void ReportCounter(const std::string &,
+                     const std::unordered_map<std::string, std::string> &,
+                     int64_t) {}
+
+  void ReportGauge(const std::string &,
+                   const std::unordered_map<std::string, std::string> &,
+                   double) {}
+
+  void ReportTimer(const std::string &name,
+                   const std::unordered_map<std::string, std::string> &tags,
+                   std::chrono::nanoseconds) {
+    Metric metric(name, tags);
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_ = std::move(metric);
+  }
+
+  void ReportHistogramValueSamples(
+      const std::string &, const std::unordered_map<std::string, std::string> &,
+      uint64_t, uint64_t, double, double, uint64_t) {}
+
+  void ReportHistogramDurationSamples(
+      const std::string &, const std::unordered_map<std::string, std::string> &,
+      uint64_t, uint64_t, std::chrono::nanoseconds, std::chrono::nanoseconds,
+      uint64_t) {}
+
+ private:
+  using Metric =
+      std::pair<std::string, std::unordered_map<std::string, std::string>>;
+
+  std::mutex mutex_;
+  Metric last_;
+};
+
+// Measures the cost of recording a duration into a Timer in each mode. The
+// argument is the Timer::Mode.
+void BM_ScopeTimerRecord(benchmark::State &state) {
+  auto const timer_scope =
+      tally::ScopeBuilder()
+          .reporter(std::make_shared<QueueingStatsReporter>())
+          .tags({{"service", "benchmark"}, {"env", "production"}})
+          .timer_mode(static_cast<tally::Timer::Mode>(state.range(0)))
+          .Build();
+  auto timer = timer_scope->Timer("timer");
+  for (auto _ : state) {
+    timer->Record(std::chrono::microseconds(250));
+  }
+}
+
+// Measures recording into a single Sampled Timer from every thread. The
+// Timer's writer counts are striped across as many cells as the Scope's
+// counters, so recorders only contend on the interval's count of durations.
+const std::unique_ptr<tally::Scope> sampled_scope =
+    tally::ScopeBuilder()
+        .timer_mode(tally::Timer::Mode::Sampled)
+        .counter_stripes(16)
+        .Build();
+
+void BM_ScopeSampledTimerRecordContended(benchmark::State &state) {
+  auto timer = sampled_scope->Timer("timer");
+  for (auto _ : state) {
+    timer->Record(std::chrono::microseconds(250));
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ScopeCounterIncPerThread)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK(BM_ScopeCounterLookup)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK(BM_ScopeCounterLookupLiteral);
+
+BENCHMARK(BM_ScopeSubScope)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK(BM_ScopeTagged)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK(BM_ScopeGaugeUpdatePerThread)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK(BM_ScopeHistogramRecordPerThread)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK(BM_ScopeReport)->Arg(1000);
+
+BENCHMARK(BM_ScopeReportConvertingTags)->Arg(0)->Arg(1);
+
+BENCHMARK(BM_ScopeTimerRecord)
+    ->Arg(static_cast<int64_t>(tally::Timer::Mode::Immediate))
+    ->Arg(static_cast<int64_t>(tally::Timer::Mode::Buffered))
+    ->Arg(static_cast<int64_t>(tally::Timer::Mode::Sampled));
+
+BENCHMARK(BM_ScopeSampledTimerRecordContended)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <vector>
 
 #include "tally/buckets_iterator.h"
@@ -48,6 +49,27 @@ class Buckets {
   static Buckets ExponentialDurations(std::chrono::nanoseconds start,
                                       uint64_t factor, uint64_t num);
 
+  // LogLinearValues constructs a log-linear sequence of Value buckets, as used
+  // by HdrHistogram, which splits each power of two into 2^`significant_bits`
+  // equally sized buckets so that every bucket's width is within a relative
+  // error of 2^-`significant_bits` of its values. The sequence begins at one
+  // and continues until the bucket which contains `max`.
+  static Buckets LogLinearValues(uint32_t significant_bits, uint64_t max);
+
+  // LogLinearDurations constructs a log-linear sequence of Duration buckets
+  // which splits each power of two nanoseconds into 2^`significant_bits`
+  // equally sized buckets, continuing until the bucket which contains `max`.
+  static Buckets LogLinearDurations(uint32_t significant_bits,
+                                    std::chrono::nanoseconds max);
+
+  // CustomValues constructs a sequence of Value buckets with the provided
+  // `bounds`, which must be non-empty and strictly ascending.
+  static Buckets CustomValues(std::vector<double> bounds);
+
+  // CustomDurations constructs a sequence of Duration buckets with the
+  // provided `bounds`, which must be non-empty and strictly ascending.
+  static Buckets CustomDurations(std::vector<std::chrono::nanoseconds> bounds);
+
   // Kind is an enum representing the type of a sequence of buckets.
   enum class Kind {
     Values,
@@ -62,6 +84,8 @@ class Buckets {
 
   Kind kind() const { return kind_; }
 
+  BucketsCalculator calculator() const { return calculator_; }
+
  private:
   Buckets(Kind kind, BucketsCalculator calculator, uint64_t num);
 
@@ -32,6 +32,12 @@ class Capabilities {
 
   // Tagging returns a bool indicating whether tagged metrics are supported.
   virtual bool Tagging() const = 0;
+
+  // AggregatedTimers returns a bool indicating whether timers are preferred to
+  // be aggregated into histograms of their durations, and reported once per
+  // reporting interval, over having every duration reported as it is recorded.
+  // It returns false unless overridden.
+  virtual bool AggregatedTimers() const { return false; }
 };
 
 }  // namespace tally
@@ -0,0 +1,57 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+namespace tally {
+
+// Clock is the source of the instants which Stopwatches and the Timers and
+// Histograms they record into measure durations between. It is shared by the
+// whole process so that a Stopwatch started under one source is stopped under
+// the same one. Every source expresses instants as steady_clock time points
+// with the same epoch, so durations which span a change of source remain
+// approximately correct.
+class Clock {
+ public:
+  enum class Source {
+    // Steady reads std::chrono::steady_clock, which is the default.
+    Steady,
+    // TSC reads the processor's time-stamp counter, which is several times
+    // cheaper than steady_clock on x86-64 processors with an invariant TSC.
+    // Its rate is calibrated against steady_clock when it is first selected.
+    TSC,
+  };
+
+  // Now returns the current instant according to the selected source.
+  static std::chrono::steady_clock::time_point Now() noexcept;
+
+  // Use selects the source which Now reads from. It returns false and leaves
+  // the source unchanged if the source is not supported on this machine, such
+  // as the TSC on processors whose TSC rate varies with their frequency or
+  // which are not x86-64.
+  static bool Use(Source source) noexcept;
+
+  // source returns the source which Now reads from.
+  static Source source() noexcept;
+};
+
+}  // namespace tally
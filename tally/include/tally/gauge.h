@@ -24,9 +24,23 @@ namespace tally {
 
 class Gauge {
  public:
+  // Aggregation is an enum representing how the updates made to a Gauge within
+  // a reporting interval are combined into the value which is reported.
+  enum class Aggregation {
+    // Last reports the most recent update.
+    Last,
+    // Max reports the largest update.
+    Max,
+    // Min reports the smallest update.
+    Min,
+    // Sum reports the sum of all updates.
+    Sum,
+  };
+
   virtual ~Gauge() = default;
 
-  // Set the value of the Gauge.
+  // Set the value of the Gauge, or combine the value with those already set in
+  // the current reporting interval according to the Gauge's Aggregation.
   virtual void Update(double) noexcept = 0;
 };
 
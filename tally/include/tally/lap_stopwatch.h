@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+#include "tally/histogram.h"
+#include "tally/timer.h"
+
+namespace tally {
+
+// LapStopwatch times consecutive phases of an operation, such as parsing,
+// processing and responding to a request, by reading the Clock once at its
+// construction and once at the end of each phase. Each Lap records the time
+// since the previous one into the provided Timer or Histogram, so timing N
+// phases reads the Clock N + 1 times rather than the 2N times separate
+// Stopwatches would. Like a ScopedStopwatch it does not own the metrics it
+// records into.
+class LapStopwatch {
+ public:
+  LapStopwatch() noexcept;
+
+  // Ensure the class is non-copyable.
+  LapStopwatch(const LapStopwatch &) = delete;
+
+  LapStopwatch &operator=(const LapStopwatch &) = delete;
+
+  // Lap ends the current phase, records its duration into `timer` or
+  // `histogram` and begins the next phase. It returns the duration of the
+  // phase which ended.
+  std::chrono::nanoseconds Lap(Timer &timer);
+
+  std::chrono::nanoseconds Lap(Histogram &histogram);
+
+  // Skip ends the current phase without recording it and begins the next one.
+  void Skip() noexcept;
+
+ private:
+  // Next returns the duration since the previous lap and begins the next one.
+  std::chrono::nanoseconds Next() noexcept;
+
+  std::chrono::steady_clock::time_point last_;
+};
+
+}  // namespace tally
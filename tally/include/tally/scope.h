@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -40,18 +42,103 @@ class Scope {
   virtual std::shared_ptr<tally::Counter> Counter(
       const std::string &name) noexcept = 0;
 
+  // Counter returns a new Counter with the provided null-terminated name.
+  // Like the other overloads taking names as C strings, it avoids constructing
+  // a std::string when the metric already exists, so looking up a metric by a
+  // string literal allocates nothing. Unless overridden, each of them forwards
+  // to the overload taking a std::string. Subclasses which override only the
+  // std::string overloads hide these, so should bring them into scope with a
+  // using-declaration.
+  virtual std::shared_ptr<tally::Counter> Counter(const char *name) noexcept {
+    return Counter(std::string(name));
+  }
+
+  // LocalCounter returns a handle to the Counter with the provided name which
+  // buffers increments in a plain integer owned by the handle, avoiding atomic
+  // operations on the hot path. A handle must only be used from a single
+  // thread, typically by storing it in a thread_local variable. Its increments
+  // are included whenever the Counter is reported and are folded into the
+  // Counter when the handle is destroyed. Unless overridden, it returns a
+  // handle which increments the Counter directly.
+  virtual std::unique_ptr<tally::Counter> LocalCounter(
+      const std::string &name) noexcept;
+
   // Gauge returns a new Gauge with the provided name.
   virtual std::shared_ptr<tally::Gauge> Gauge(
       const std::string &name) noexcept = 0;
 
+  // Gauge returns a new Gauge with the provided null-terminated name.
+  virtual std::shared_ptr<tally::Gauge> Gauge(const char *name) noexcept {
+    return Gauge(std::string(name));
+  }
+
+  // Gauge returns a new Gauge with the provided name which combines the
+  // updates made to it within each reporting interval using `aggregation`. If
+  // a Gauge with the name already exists it is returned unchanged. Unless
+  // overridden, it returns Gauge(name), so Scopes which do not support
+  // aggregation report the last update for every aggregation.
+  virtual std::shared_ptr<tally::Gauge> Gauge(
+      const std::string &name, tally::Gauge::Aggregation) noexcept {
+    return Gauge(name);
+  }
+
+  // Gauge returns a new Gauge with the provided null-terminated name which
+  // combines its updates using `aggregation`.
+  virtual std::shared_ptr<tally::Gauge> Gauge(
+      const char *name, tally::Gauge::Aggregation aggregation) noexcept {
+    return Gauge(std::string(name), aggregation);
+  }
+
+  // CallbackGauge registers a Gauge with the provided name whose value is
+  // obtained by invoking `callback` each time the Scope reports its metrics.
+  // This suits values which change far more often than they are reported,
+  // such as queue lengths, since nothing needs to be done when they change.
+  // The callback is invoked on the reporting thread so it must be thread-safe,
+  // and it is kept until the Scope is destroyed so anything it captures must
+  // outlive the Scope. If the callback throws, the gauge is not reported for
+  // that interval. If a callback has already been registered with the name it
+  // is kept. Scopes which cannot invoke callbacks when they report discard
+  // the callback without invoking it.
+  virtual void CallbackGauge(const std::string &name,
+                             std::function<double()> callback) noexcept {}
+
   // Timer returns a new Timer with the provided name.
   virtual std::shared_ptr<tally::Timer> Timer(
       const std::string &name) noexcept = 0;
 
+  // Timer returns a new Timer with the provided null-terminated name.
+  virtual std::shared_ptr<tally::Timer> Timer(const char *name) noexcept {
+    return Timer(std::string(name));
+  }
+
   // Histogram returns a new Histogram with the provided name.
   virtual std::shared_ptr<tally::Histogram> Histogram(
       const std::string &name, const Buckets &buckets) noexcept = 0;
 
+  // Histogram returns a new Histogram with the provided null-terminated name.
+  virtual std::shared_ptr<tally::Histogram> Histogram(
+      const char *name, const Buckets &buckets) noexcept {
+    return Histogram(std::string(name), buckets);
+  }
+
+  // Sketch returns a new Histogram with the provided name which counts values
+  // in a quantile sketch rather than in fixed buckets. Its buckets grow
+  // logarithmically so that any value is within `relative_accuracy` of the
+  // bucket it is reported in, and each reporting interval it also reports its
+  // 50th, 75th, 90th, 95th, 99th and 99.9th percentiles as gauges suffixed by
+  // "p50" through "p999", which are within `relative_accuracy` of the true
+  // percentiles. Memory is bounded by collapsing the buckets nearest zero. The
+  // buckets are reported as the provided `kind`. If a Sketch with the name
+  // already exists it is returned unchanged. Throws std::invalid_argument if
+  // `relative_accuracy` does not lie in (0, 1), or for Scopes built by a
+  // ScopeBuilder if it is finer than about 3.3e-7. Scopes which do not
+  // implement sketches return a Histogram with log-linear buckets no wider
+  // than `relative_accuracy`, or 1/128th, of each power of two up to 2^32, or
+  // 2^36 nanoseconds for durations, and report no percentiles.
+  virtual std::shared_ptr<tally::Histogram> Sketch(const std::string &name,
+                                                   Buckets::Kind kind,
+                                                   double relative_accuracy);
+
   // SubScope creates a new child scope with the same tags as the parent but
   // with the additional name.
   virtual std::shared_ptr<Scope> SubScope(const std::string &name) noexcept = 0;
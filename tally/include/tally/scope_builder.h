@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 
@@ -27,6 +28,7 @@
 #include "tally/scope.h"
 #include "tally/src/noop_stats_reporter.h"
 #include "tally/stats_reporter.h"
+#include "tally/timer.h"
 
 namespace tally {
 
@@ -46,6 +48,29 @@ class ScopeBuilder {
 
   ScopeBuilder &reporting_interval(std::chrono::seconds interval) noexcept;
 
+  // counter_stripes sets the number of cache-line-padded cells each Counter
+  // created by the Scope spreads its increments across. Striping trades memory
+  // for throughput when many threads increment the same Counter concurrently.
+  // The default of one stripe disables striping.
+  ScopeBuilder &counter_stripes(uint32_t stripes) noexcept;
+
+  // histogram_shards sets the number of copies of its bucket counts each
+  // Histogram created by the Scope keeps, with each thread recording into one
+  // of them, which are merged when the Histogram is reported. Like striping,
+  // sharding trades memory for throughput when many threads record into the
+  // same Histogram concurrently. The default of one shard disables sharding.
+  ScopeBuilder &histogram_shards(uint32_t shards) noexcept;
+
+  // timer_mode sets when the durations recorded by each Timer created by the
+  // Scope are reported. The default of Immediate reports every duration as it
+  // is recorded, whereas Buffered aggregates them and reports the aggregates
+  // once per reporting interval.
+  ScopeBuilder &timer_mode(Timer::Mode mode) noexcept;
+
+  // timer_reservoir_size sets the maximum number of durations each Sampled
+  // Timer created by the Scope reports per reporting interval.
+  ScopeBuilder &timer_reservoir_size(uint32_t size) noexcept;
+
   // Build constructs a Scope and begins reporting metrics if the scope's
   // reporting interval is non-zero.
   std::unique_ptr<Scope> Build() noexcept;
@@ -54,6 +79,10 @@ class ScopeBuilder {
   std::string prefix_;
   std::string separator_;
   std::chrono::seconds reporting_interval_;
+  uint32_t counter_stripes_;
+  uint32_t histogram_shards_;
+  Timer::Mode timer_mode_;
+  uint32_t timer_reservoir_size_;
   std::unordered_map<std::string, std::string> tags_;
   std::shared_ptr<StatsReporter> reporter_;
 };
@@ -0,0 +1,61 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+#include "tally/histogram.h"
+#include "tally/timer.h"
+
+namespace tally {
+
+// ScopedStopwatch measures the time from its construction until it is stopped
+// or destroyed and records it into a Timer or Histogram. Unlike a Stopwatch it
+// holds a plain reference to the metric rather than sharing ownership of it, so
+// timing a section costs only the two reads of the Clock and the record. The
+// metric must therefore outlive the ScopedStopwatch, which holds for metrics
+// created by a Scope that outlives it.
+class ScopedStopwatch {
+ public:
+  explicit ScopedStopwatch(Timer &timer) noexcept;
+
+  explicit ScopedStopwatch(Histogram &histogram) noexcept;
+
+  // Ensure the class is non-copyable.
+  ScopedStopwatch(const ScopedStopwatch &) = delete;
+
+  ScopedStopwatch &operator=(const ScopedStopwatch &) = delete;
+
+  // The destructor records the duration of time since the ScopedStopwatch was
+  // constructed unless it has already been stopped.
+  ~ScopedStopwatch();
+
+  // Stop records the duration of time since the ScopedStopwatch was
+  // constructed. Subsequent calls and the destructor do nothing.
+  void Stop();
+
+ private:
+  const std::chrono::steady_clock::time_point start_;
+  Timer *timer_;
+  Histogram *histogram_;
+};
+
+}  // namespace tally
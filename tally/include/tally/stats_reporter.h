@@ -29,6 +29,7 @@
 #include "tally/base_stats_reporter.h"
 #include "tally/buckets.h"
 #include "tally/histogram.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
@@ -64,6 +65,43 @@ class StatsReporter : public BaseStatsReporter {
       uint64_t bucket_id, uint64_t num_buckets,
       std::chrono::nanoseconds buckets_lower_bound,
       std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) = 0;
+
+  // Methods to report metrics with tags held by a TagSet, which is what Scopes
+  // report their metrics with. Reporters may override them to avoid converting
+  // the same tags on every report, and otherwise they pass the tags as a map to
+  // the methods above.
+  virtual void ReportCounter(const std::string &name, const TagSet &tags,
+                             int64_t value) {
+    ReportCounter(name, tags.AsMap(), value);
+  }
+
+  virtual void ReportGauge(const std::string &name, const TagSet &tags,
+                           double value) {
+    ReportGauge(name, tags.AsMap(), value);
+  }
+
+  virtual void ReportTimer(const std::string &name, const TagSet &tags,
+                           std::chrono::nanoseconds value) {
+    ReportTimer(name, tags.AsMap(), value);
+  }
+
+  virtual void ReportHistogramValueSamples(
+      const std::string &name, const TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, double buckets_lower_bound,
+      double buckets_upper_bound, uint64_t samples) {
+    ReportHistogramValueSamples(name, tags.AsMap(), bucket_id, num_buckets,
+                                buckets_lower_bound, buckets_upper_bound,
+                                samples);
+  }
+
+  virtual void ReportHistogramDurationSamples(
+      const std::string &name, const TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+      std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {
+    ReportHistogramDurationSamples(name, tags.AsMap(), bucket_id, num_buckets,
+                                   buckets_lower_bound, buckets_upper_bound,
+                                   samples);
+  }
 };
 
 }  // namespace tally
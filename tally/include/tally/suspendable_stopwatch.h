@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+#include "tally/histogram.h"
+#include "tally/timer.h"
+
+namespace tally {
+
+// SuspendableStopwatch measures an operation which is suspended and resumed,
+// such as a coroutine awaiting I/O, and records both the wall time from its
+// construction until it is stopped and the active time, which excludes the
+// periods it was suspended. It is intended to be kept alongside the operation's
+// state, e.g. as a local variable of a coroutine, with the operation's awaiters
+// calling Suspend before it suspends and Resume once it has resumed. Comparing
+// the two durations shows whether an operation's latency is spent executing or
+// waiting. Like a ScopedStopwatch it does not own the metrics it records into.
+class SuspendableStopwatch {
+ public:
+  // SuspendableStopwatch starts measuring, in the active state, and records the
+  // wall and active times into the respective Timers or Histograms when it is
+  // stopped.
+  SuspendableStopwatch(Timer &wall, Timer &active) noexcept;
+
+  SuspendableStopwatch(Histogram &wall, Histogram &active) noexcept;
+
+  // Ensure the class is non-copyable.
+  SuspendableStopwatch(const SuspendableStopwatch &) = delete;
+
+  SuspendableStopwatch &operator=(const SuspendableStopwatch &) = delete;
+
+  // The destructor stops the SuspendableStopwatch if it has not already been
+  // stopped.
+  ~SuspendableStopwatch();
+
+  // Suspend stops accumulating active time. It does nothing if the
+  // SuspendableStopwatch is already suspended or has been stopped.
+  void Suspend() noexcept;
+
+  // Resume begins accumulating active time again. It does nothing unless the
+  // SuspendableStopwatch is suspended.
+  void Resume() noexcept;
+
+  // Stop records the wall and active times measured so far. Subsequent calls
+  // and the destructor do nothing.
+  void Stop();
+
+ private:
+  enum class State {
+    Active,
+    Suspended,
+    Stopped,
+  };
+
+  const std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point resumed_;
+  std::chrono::nanoseconds active_;
+  State state_;
+
+  // The metrics which the wall and active times are recorded into, of which
+  // either the Timers or the Histograms are null.
+  Timer *const wall_timer_;
+  Timer *const active_timer_;
+  Histogram *const wall_histogram_;
+  Histogram *const active_histogram_;
+};
+
+}  // namespace tally
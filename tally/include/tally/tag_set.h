@@ -0,0 +1,117 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tally {
+
+// TagSet is an immutable set of tags, sorted by name, with a precomputed hash.
+// Scopes hold their tags as interned TagSets, so that a tree of scopes with
+// the same tags shares a single copy of them, and pass them to the reporters
+// their metrics are reported to, which can use them to key caches of whatever
+// form they convert tags into.
+class TagSet {
+ public:
+  using Tag = std::pair<std::string, std::string>;
+
+  using const_iterator = std::vector<Tag>::const_iterator;
+
+  // Hasher hashes a TagSet by its precomputed hash, for use as the key of an
+  // unordered container.
+  struct Hasher {
+    std::size_t operator()(const TagSet &tags) const noexcept {
+      return static_cast<std::size_t>(tags.hash());
+    }
+  };
+
+  // TagSet constructs a TagSet holding the provided tags. Intern should be
+  // used instead wherever the TagSet is long-lived.
+  explicit TagSet(const std::unordered_map<std::string, std::string> &tags);
+
+  TagSet(const TagSet &other);
+
+  // Ensure the class is immutable.
+  TagSet &operator=(const TagSet &) = delete;
+
+  // Intern returns the TagSet holding the provided tags which is shared by
+  // every caller of Intern with the same tags while any of them holds it.
+  static std::shared_ptr<const TagSet> Intern(
+      const std::unordered_map<std::string, std::string> &tags);
+
+  // Merge returns the interned TagSet holding the provided tags and those of
+  // this TagSet, with the provided tags taking precedence.
+  std::shared_ptr<const TagSet> Merge(
+      const std::unordered_map<std::string, std::string> &tags) const;
+
+  const_iterator begin() const noexcept { return tags_.begin(); }
+
+  const_iterator end() const noexcept { return tags_.end(); }
+
+  std::size_t size() const noexcept { return tags_.size(); }
+
+  bool empty() const noexcept { return tags_.empty(); }
+
+  // hash returns the hash of the TagSet's tags.
+  uint64_t hash() const noexcept { return hash_; }
+
+  // AsMap returns the TagSet's tags as a map, which is constructed the first
+  // time it is called for reporters which only accept tags as maps.
+  const std::unordered_map<std::string, std::string> &AsMap() const;
+
+  bool operator==(const TagSet &other) const noexcept;
+
+  bool operator!=(const TagSet &other) const noexcept {
+    return !(*this == other);
+  }
+
+ private:
+  // TagSet constructs a TagSet holding the provided tags, which must be sorted
+  // by name with no name repeated, and their hash.
+  TagSet(std::vector<Tag> tags, uint64_t hash);
+
+  // InternSorted returns the interned TagSet holding the provided tags, which
+  // must be sorted by name with no name repeated.
+  static std::shared_ptr<const TagSet> InternSorted(std::vector<Tag> tags);
+
+  // Sort returns the provided tags sorted by name.
+  static std::vector<Tag> Sort(
+      const std::unordered_map<std::string, std::string> &tags);
+
+  // Hash returns the hash of the provided tags, which must be sorted by name.
+  static uint64_t Hash(const std::vector<Tag> &tags) noexcept;
+
+  const std::vector<Tag> tags_;
+  const uint64_t hash_;
+
+  mutable std::once_flag map_once_;
+  mutable std::unique_ptr<const std::unordered_map<std::string, std::string>>
+      map_;
+};
+
+}  // namespace tally
@@ -21,6 +21,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 
 #include "tally/stopwatch.h"
 
@@ -28,6 +30,23 @@ namespace tally {
 
 class Timer {
  public:
+  // Mode is an enum representing when the durations recorded by a Timer are
+  // passed to the reporter.
+  enum class Mode {
+    // Immediate reports every duration as it is recorded.
+    Immediate,
+    // Buffered aggregates the durations recorded within a reporting interval
+    // into their count, sum, minimum, maximum and a histogram of their
+    // distribution, which are reported once at the end of the interval.
+    Buffered,
+    // Sampled keeps a fixed-size uniform random sample of the durations
+    // recorded within a reporting interval, along with their exact count and
+    // sum. Only the sampled durations are reported at the end of the interval,
+    // alongside the rate at which they were sampled, so the number of timer
+    // metrics reported per interval is bounded regardless of traffic.
+    Sampled,
+  };
+
   virtual ~Timer() = default;
 
   // Record emits the provided duration of time as a timer metric.
@@ -36,6 +55,15 @@ class Timer {
   // Record emits the provided value as a timer metric.
   virtual void Record(int64_t) = 0;
 
+  // RecordMany emits each of the `num` durations beginning at `values` as a
+  // timer metric. It records each of them in turn unless overridden.
+  virtual void RecordMany(const std::chrono::nanoseconds *values,
+                          std::size_t num) {
+    for (std::size_t i = 0; i < num; i++) {
+      Record(values[i]);
+    }
+  }
+
   // Start returns a new Stopwatch from the current instant.
   virtual Stopwatch Start() = 0;
 };
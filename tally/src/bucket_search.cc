@@ -0,0 +1,233 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/bucket_search.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TALLY_BUCKET_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace tally {
+
+namespace {
+
+// The number of bounds in each block. Both levels are compared exhaustively,
+// so this balances the vectors compared within a block against those compared
+// to find it for the 16 to 128 bucket layouts of typical latency histograms.
+constexpr std::size_t BLOCK_SIZE = 8;
+
+// The number of bounds compared at once by the widest instruction set, which
+// every padded array is a multiple of.
+constexpr std::size_t LANES = 4;
+
+// The largest number of blocks which are found by comparing against the last
+// bound of every block. Beyond this, i.e. above 256 bounds, comparing against
+// every block costs more than a binary search over them.
+constexpr std::size_t MAX_COUNTED_BLOCKS = 32;
+
+// SearchBlocks returns the number of the `num` ascending `bounds` which `value`
+// is not less than, like std::upper_bound, halving the range with conditional
+// moves rather than branches so that it does not mispredict on random values.
+inline std::size_t SearchBlocks(const double *bounds, std::size_t num,
+                                double value) {
+  auto base = bounds;
+  while (num > 1) {
+    auto const half = num / 2;
+    base = !(value < base[half - 1]) ? base + half : base;
+    num -= half;
+  }
+  return static_cast<std::size_t>(base - bounds) + !(value < *base);
+}
+
+// FindBlock returns the index within the padded bounds of the first bound which
+// is greater than `value`, given a function which counts the bounds among a
+// multiple of four which `value` is not less than. Padding counts towards NaN
+// values, which compare false against everything, hence the clamp on the
+// block. It is always inlined so that each instruction set gets its own copy
+// with `count` inlined.
+template <typename Count>
+inline __attribute__((always_inline)) std::size_t FindBlock(
+    const double *bounds, const double *block_bounds,
+    std::size_t num_block_bounds, std::size_t num_blocks, double value,
+    Count count) {
+  auto const block = std::min(
+      num_block_bounds > MAX_COUNTED_BLOCKS
+          ? SearchBlocks(block_bounds, num_block_bounds, value)
+          : count(block_bounds, num_block_bounds, value),
+      num_blocks);
+  auto const offset = block * BLOCK_SIZE;
+  return offset + count(bounds + offset, BLOCK_SIZE, value);
+}
+
+inline std::size_t CountScalar(const double *bounds, std::size_t num,
+                               double value) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < num; i++) {
+    // Comparing with !(value < bound) rather than bound <= value counts NaN
+    // values past every bound, matching std::upper_bound.
+    count += !(value < bounds[i]);
+  }
+  return count;
+}
+
+std::size_t FindScalar(const double *bounds, const double *block_bounds,
+                       std::size_t num_block_bounds, std::size_t num_blocks,
+                       double value) {
+  return FindBlock(bounds, block_bounds, num_block_bounds, num_blocks, value,
+                   CountScalar);
+}
+
+#ifdef TALLY_BUCKET_SEARCH_X86
+
+// The vectorized counts rely on each comparison which holds setting its lane
+// to all ones, i.e. minus one, so subtracting the comparison masks counts them
+// in each lane without moving them out of vector registers.
+inline std::size_t CountSSE2(const double *bounds, std::size_t num,
+                             double value) {
+  auto const values = _mm_set1_pd(value);
+  auto counts = _mm_setzero_si128();
+  for (std::size_t i = 0; i < num; i += 2) {
+    auto const mask = _mm_cmpnlt_pd(values, _mm_loadu_pd(bounds + i));
+    counts = _mm_sub_epi64(counts, _mm_castpd_si128(mask));
+  }
+  counts = _mm_add_epi64(counts, _mm_unpackhi_epi64(counts, counts));
+  return static_cast<std::size_t>(_mm_cvtsi128_si64(counts));
+}
+
+std::size_t FindSSE2(const double *bounds, const double *block_bounds,
+                     std::size_t num_block_bounds, std::size_t num_blocks,
+                     double value) {
+  return FindBlock(bounds, block_bounds, num_block_bounds, num_blocks, value,
+                   CountSSE2);
+}
+
+__attribute__((target("avx2"))) inline std::size_t CountAVX2(
+    const double *bounds, std::size_t num, double value) {
+  auto const values = _mm256_set1_pd(value);
+  auto counts = _mm256_setzero_si256();
+  for (std::size_t i = 0; i < num; i += 4) {
+    auto const mask =
+        _mm256_cmp_pd(values, _mm256_loadu_pd(bounds + i), _CMP_NLT_UQ);
+    counts = _mm256_sub_epi64(counts, _mm256_castpd_si256(mask));
+  }
+  auto sums = _mm_add_epi64(_mm256_castsi256_si128(counts),
+                            _mm256_extracti128_si256(counts, 1));
+  sums = _mm_add_epi64(sums, _mm_unpackhi_epi64(sums, sums));
+  return static_cast<std::size_t>(_mm_cvtsi128_si64(sums));
+}
+
+__attribute__((target("avx2"))) std::size_t FindAVX2(
+    const double *bounds, const double *block_bounds,
+    std::size_t num_block_bounds, std::size_t num_blocks, double value) {
+  return FindBlock(bounds, block_bounds, num_block_bounds, num_blocks, value,
+                   CountAVX2);
+}
+
+#endif  // TALLY_BUCKET_SEARCH_X86
+
+std::size_t RoundUp(std::size_t num, std::size_t multiple) {
+  return (num + multiple - 1) / multiple * multiple;
+}
+
+std::vector<double> PaddedBounds(const std::vector<double> &upper_bounds) {
+  std::vector<double> bounds(
+      RoundUp(upper_bounds.size(), BLOCK_SIZE) + BLOCK_SIZE,
+      std::numeric_limits<double>::infinity());
+  std::copy(upper_bounds.begin(), upper_bounds.end(), bounds.begin());
+  return bounds;
+}
+
+std::vector<double> BlockBounds(const std::vector<double> &upper_bounds) {
+  auto const num_blocks = RoundUp(upper_bounds.size(), BLOCK_SIZE) / BLOCK_SIZE;
+  std::vector<double> block_bounds(RoundUp(num_blocks, LANES),
+                                   std::numeric_limits<double>::infinity());
+  for (std::size_t i = 0; i < num_blocks; i++) {
+    auto const last = std::min((i + 1) * BLOCK_SIZE, upper_bounds.size()) - 1;
+    block_bounds[i] = upper_bounds[last];
+  }
+  return block_bounds;
+}
+
+}  // namespace
+
+bool BucketSearch::Supports(Instructions instructions) noexcept {
+  switch (instructions) {
+    case Instructions::Scalar:
+      return true;
+#ifdef TALLY_BUCKET_SEARCH_X86
+    case Instructions::SSE2:
+      // SSE2 is part of the x86-64 baseline.
+      return true;
+    case Instructions::AVX2:
+      return __builtin_cpu_supports("avx2");
+#else
+    case Instructions::SSE2:
+    case Instructions::AVX2:
+      return false;
+#endif
+  }
+  return false;
+}
+
+BucketSearch::Instructions BucketSearch::Best() noexcept {
+  if (Supports(Instructions::AVX2)) {
+    return Instructions::AVX2;
+  }
+  if (Supports(Instructions::SSE2)) {
+    return Instructions::SSE2;
+  }
+  return Instructions::Scalar;
+}
+
+BucketSearch::BucketSearch(const std::vector<double> &upper_bounds)
+    : BucketSearch(upper_bounds, Best()) {}
+
+BucketSearch::BucketSearch(const std::vector<double> &upper_bounds,
+                           Instructions instructions)
+    : num_bounds_(upper_bounds.size()),
+      num_blocks_(RoundUp(upper_bounds.size(), BLOCK_SIZE) / BLOCK_SIZE),
+      find_(
+#ifdef TALLY_BUCKET_SEARCH_X86
+          instructions == Instructions::AVX2
+              ? FindAVX2
+              : instructions == Instructions::SSE2 ? FindSSE2 : FindScalar
+#else
+          FindScalar
+#endif
+          ),
+      bounds_(PaddedBounds(upper_bounds)),
+      block_bounds_(BlockBounds(upper_bounds)) {
+  (void)instructions;
+}
+
+uint64_t BucketSearch::Find(double value) const noexcept {
+  auto const index = find_(bounds_.data(), block_bounds_.data(),
+                           block_bounds_.size(), num_blocks_, value);
+  return std::min(index, num_bounds_);
+}
+
+}  // namespace tally
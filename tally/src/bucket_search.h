@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tally {
+
+// BucketSearch finds the bucket which a value falls into among arbitrary
+// ascending upper bounds without the unpredictable branches of a binary
+// search. The bounds are split into fixed-size blocks and the value is
+// compared against every bound in the block it falls into, as well as the last
+// bound of every block to find that block, counting the comparisons which
+// hold with SIMD instructions where the CPU supports them. Above 256 bounds
+// the block is found with a branchless binary search over the last bounds of
+// the blocks instead.
+class BucketSearch {
+ public:
+  // Instructions is an enum representing the instruction set used to compare
+  // values against bounds.
+  enum class Instructions {
+    Scalar,
+    SSE2,
+    AVX2,
+  };
+
+  // Supports returns whether the current CPU supports `instructions`.
+  static bool Supports(Instructions instructions) noexcept;
+
+  // Best returns the widest instruction set supported by the current CPU.
+  static Instructions Best() noexcept;
+
+  // BucketSearch searches `upper_bounds` using the best instruction set
+  // supported by the current CPU.
+  explicit BucketSearch(const std::vector<double> &upper_bounds);
+
+  // BucketSearch searches `upper_bounds` using `instructions`, which must be
+  // supported by the current CPU.
+  BucketSearch(const std::vector<double> &upper_bounds,
+               Instructions instructions);
+
+  // Find returns the number of upper bounds which are less than or equal to
+  // `value`, which is the same as the index returned by std::upper_bound.
+  uint64_t Find(double value) const noexcept;
+
+ private:
+  // FindFunction returns the index within the padded `bounds` of the first
+  // bound which is greater than `value`, using a particular instruction set.
+  using FindFunction = std::size_t (*)(const double *bounds,
+                                       const double *block_bounds,
+                                       std::size_t num_block_bounds,
+                                       std::size_t num_blocks, double value);
+
+  const std::size_t num_bounds_;
+  const std::size_t num_blocks_;
+  const FindFunction find_;
+
+  // The bounds padded with positive infinity to fill whole blocks, followed by
+  // a block consisting only of padding which values beyond every bound fall
+  // into.
+  std::vector<double> bounds_;
+
+  // The last bound of each block, padded with positive infinity to a multiple
+  // of four.
+  std::vector<double> block_bounds_;
+};
+
+}  // namespace tally
@@ -20,13 +20,49 @@
 
 #include "tally/buckets.h"
 
+#include <memory>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "tally/buckets_iterator.h"
 #include "tally/src/buckets_calculator.h"
 
 namespace tally {
 
+namespace {
+
+BucketsCalculator ExplicitCalculator(std::vector<double> bounds) {
+  if (bounds.empty()) {
+    throw std::invalid_argument("Number of buckets cannot be zero");
+  }
+
+  for (std::size_t i = 1; i < bounds.size(); i++) {
+    if (!(bounds[i - 1] < bounds[i])) {
+      throw std::invalid_argument("Bucket bounds must be strictly ascending");
+    }
+  }
+
+  return BucketsCalculator(
+      std::make_shared<const std::vector<double>>(std::move(bounds)));
+}
+
+// The largest number of significant bits, which keeps the number of buckets
+// below 2^26 for any 64-bit maximum.
+const uint32_t MAX_SIGNIFICANT_BITS = 20;
+
+BucketsCalculator LogLinearCalculator(uint32_t significant_bits) {
+  if (significant_bits == 0 || significant_bits > MAX_SIGNIFICANT_BITS) {
+    throw std::invalid_argument(
+        "Number of significant bits must lie in [1, 20]");
+  }
+
+  return BucketsCalculator(BucketsCalculator::Growth::LogLinear, 0,
+                           significant_bits);
+}
+
+}  // namespace
+
 Buckets::Buckets(Buckets::Kind kind, BucketsCalculator calculator, uint64_t num)
     : kind_(kind), calculator_(calculator), num_(num) {
   if (num == 0) {
@@ -77,6 +113,42 @@ Buckets Buckets::ExponentialDurations(std::chrono::nanoseconds start,
   return Buckets(Buckets::Kind::Durations, calculator, num);
 }
 
+Buckets Buckets::LogLinearValues(uint32_t significant_bits, uint64_t max) {
+  auto const calculator = LogLinearCalculator(significant_bits);
+  auto const num = BucketsCalculator::LogLinearIndex(max, significant_bits) + 1;
+  return Buckets(Buckets::Kind::Values, calculator, num);
+}
+
+Buckets Buckets::LogLinearDurations(uint32_t significant_bits,
+                                    std::chrono::nanoseconds max) {
+  if (max < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("Maximum duration cannot be negative");
+  }
+
+  auto const calculator = LogLinearCalculator(significant_bits);
+  auto const num = BucketsCalculator::LogLinearIndex(
+                       static_cast<uint64_t>(max.count()), significant_bits) +
+                   1;
+  return Buckets(Buckets::Kind::Durations, calculator, num);
+}
+
+Buckets Buckets::CustomValues(std::vector<double> bounds) {
+  auto const num = bounds.size();
+  auto const calculator = ExplicitCalculator(std::move(bounds));
+  return Buckets(Buckets::Kind::Values, calculator, num);
+}
+
+Buckets Buckets::CustomDurations(std::vector<std::chrono::nanoseconds> bounds) {
+  std::vector<double> values;
+  values.reserve(bounds.size());
+  for (auto const bound : bounds) {
+    values.push_back(static_cast<double>(bound.count()));
+  }
+
+  auto const calculator = ExplicitCalculator(std::move(values));
+  return Buckets(Buckets::Kind::Durations, calculator, bounds.size());
+}
+
 BucketsIterator Buckets::begin() const {
   return BucketsIterator(calculator_, 0);
 }
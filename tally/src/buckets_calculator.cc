@@ -18,25 +18,185 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "tally/src/buckets_calculator.h"
 
 namespace tally {
 
+namespace {
+
+// ExponentOf returns the unbiased binary exponent of `value`, which is
+// floor(log2(value)) for positive normal values, by reading the exponent bits
+// of its representation directly.
+int64_t ExponentOf(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return static_cast<int64_t>((bits >> 52) & 0x7ff) - 1023;
+}
+
+// ApproximateLog2 returns log2(value) for positive normal values to within
+// roughly 0.0013, which is far cheaper than std::log. The exponent bits give
+// the integer part and a cubic fitted to log2(1 + t) over [0, 1) gives the
+// fractional part from the mantissa.
+double ApproximateLog2(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  auto const exponent = static_cast<int64_t>((bits >> 52) & 0x7ff) - 1023;
+  bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+  double mantissa;
+  std::memcpy(&mantissa, &bits, sizeof(mantissa));
+  auto const t = mantissa - 1;
+  return static_cast<double>(exponent) +
+         t * (1.4234902410721342 +
+              t * (-0.5877534661956468 + t * 0.1655760775600768));
+}
+
+}  // namespace
+
 BucketsCalculator::BucketsCalculator(Growth growth, double start, double update)
-    : growth_(growth), start_(start), update_(update) {}
+    : growth_(growth),
+      start_(start),
+      update_(update),
+      inverse_start_(1 / start),
+      inverse_update_(growth == Growth::Exponential ? 1 / std::log2(update)
+                                                    : 1 / update),
+      significant_bits_(
+          growth == Growth::LogLinear ? static_cast<uint32_t>(update) : 0) {}
+
+BucketsCalculator::BucketsCalculator(
+    std::shared_ptr<const std::vector<double>> bounds)
+    : growth_(Growth::Explicit),
+      start_(0),
+      update_(0),
+      inverse_start_(0),
+      inverse_update_(0),
+      significant_bits_(0),
+      bounds_(std::move(bounds)) {}
 
 double BucketsCalculator::Calculate(uint64_t index) const {
+  if (growth_ == BucketsCalculator::Growth::Explicit) {
+    return (*bounds_)[index];
+  }
+
   if (growth_ == BucketsCalculator::Growth::Exponential) {
     return start_ * std::pow(update_, static_cast<double>(index));
   }
 
+  if (growth_ == BucketsCalculator::Growth::LogLinear) {
+    // The boundary at index i is the lower bound of the bucket with index i+1,
+    // which is (2^bits + r) * 2^(g-1) for group g = (i+1) >> bits and
+    // remainder r = (i+1) mod 2^bits, or simply i+1 in the first group.
+    auto const bucket = index + 1;
+    auto const sub_buckets = uint64_t(1) << significant_bits_;
+    auto const group = bucket >> significant_bits_;
+    if (group == 0) {
+      return static_cast<double>(bucket);
+    }
+    auto const remainder = bucket & (sub_buckets - 1);
+    return std::ldexp(static_cast<double>(sub_buckets + remainder),
+                      static_cast<int>(group - 1));
+  }
+
   return start_ + (update_ * static_cast<double>(index));
 }
 
+bool BucketsCalculator::HasClosedFormIndex() const {
+  switch (growth_) {
+    case Growth::Linear:
+      return update_ > 0;
+    case Growth::Exponential:
+      return start_ > 0 && update_ > 1;
+    case Growth::Explicit:
+      return false;
+    case Growth::LogLinear:
+      return true;
+  }
+  return false;
+}
+
+bool BucketsCalculator::HasIntegerIndex() const {
+  return growth_ == Growth::LogLinear;
+}
+
+uint64_t BucketsCalculator::IntegerIndex(int64_t value, uint64_t num) const {
+  if (value < 0) {
+    return 0;
+  }
+  return std::min(
+      LogLinearIndex(static_cast<uint64_t>(value), significant_bits_), num);
+}
+
+uint64_t BucketsCalculator::LogLinearIndex(uint64_t value,
+                                           uint32_t significant_bits) {
+  auto const sub_buckets = uint64_t(1) << significant_bits;
+  if (value < sub_buckets) {
+    return value;
+  }
+
+  // The value's highest set bit determines its group and the significant bits
+  // below it determine its sub-bucket within the group.
+  auto const highest_bit = static_cast<uint32_t>(63 - __builtin_clzll(value));
+  auto const shift = highest_bit - significant_bits;
+  return (shift + 1) * sub_buckets + ((value >> shift) - sub_buckets);
+}
+
+uint64_t BucketsCalculator::Index(double value, uint64_t num) const {
+  // Values which are not a number sort past every boundary, as they would with
+  // std::upper_bound.
+  if (std::isnan(value)) {
+    return num;
+  }
+
+  // LogLinear boundaries are integers so the number of them less than or equal
+  // to a value is the same as for its integer part, and is exact.
+  if (growth_ == Growth::LogLinear) {
+    if (value >= 18446744073709551616.0) {
+      return num;
+    }
+    return value < 0 ? 0
+                     : std::min(LogLinearIndex(static_cast<uint64_t>(value),
+                                               significant_bits_),
+                                num);
+  }
+
+  // No boundaries are less than or equal to values below the first boundary.
+  // Checking this first also ensures the logarithm below is of a value no less
+  // than one.
+  if (value < start_) {
+    return 0;
+  }
+
+  double estimate;
+  if (growth_ == Growth::Linear) {
+    estimate = (value - start_) * inverse_update_;
+  } else if (update_ == 2) {
+    // Doubling boundaries are common enough, particularly for durations, to
+    // warrant reading the logarithm straight out of the exponent bits.
+    estimate = static_cast<double>(ExponentOf(value * inverse_start_));
+  } else {
+    estimate = ApproximateLog2(value * inverse_start_) * inverse_update_;
+  }
+
+  // The boundary at index i is less than or equal to value for every i up to
+  // and including the estimate.
+  estimate = std::floor(estimate) + 1;
+  if (estimate >= static_cast<double>(num)) {
+    return num;
+  }
+  return static_cast<uint64_t>(estimate);
+}
+
 bool BucketsCalculator::operator==(BucketsCalculator other) const {
+  if (growth_ == Growth::Explicit && other.growth_ == Growth::Explicit) {
+    return bounds_ == other.bounds_ || *bounds_ == *other.bounds_;
+  }
   return growth_ == other.growth_ && start_ == other.start_ &&
          update_ == other.update_;
 }
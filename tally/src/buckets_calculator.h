@@ -21,6 +21,8 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace tally {
 
@@ -29,12 +31,48 @@ class BucketsCalculator {
   enum class Growth {
     Linear,
     Exponential,
+    Explicit,
+    // LogLinear splits each power of two into 2^`update` linear sub-buckets,
+    // i.e. keeps `update` significant bits, as HdrHistogram does. Values below
+    // 2^`update` each get a bucket of their own. `start` is unused.
+    LogLinear,
   };
 
   BucketsCalculator(Growth growth, double start, double update);
 
+  // BucketsCalculator returns each of the provided `bounds` in turn rather than
+  // calculating them from a start and an update.
+  explicit BucketsCalculator(std::shared_ptr<const std::vector<double>> bounds);
+
   double Calculate(uint64_t index) const;
 
+  // HasClosedFormIndex returns whether Index can be used to locate values among
+  // the calculated boundaries, which requires them to be strictly ascending.
+  // This is not the case for, e.g., exponential growth from a non-positive
+  // start.
+  bool HasClosedFormIndex() const;
+
+  // Index returns, in constant time, an estimate of the number of the first
+  // `num` boundaries which are less than or equal to `value`. Due to floating
+  // point rounding and an approximated logarithm the estimate may be off by
+  // one, so callers must correct it by comparing `value` with the boundaries
+  // adjacent to the estimate.
+  uint64_t Index(double value, uint64_t num) const;
+
+  // HasIntegerIndex returns whether IntegerIndex can be used to locate integer
+  // values among the calculated boundaries.
+  bool HasIntegerIndex() const;
+
+  // IntegerIndex returns the exact number of the first `num` boundaries which
+  // are less than or equal to `value` using only integer operations.
+  uint64_t IntegerIndex(int64_t value, uint64_t num) const;
+
+  // LogLinearIndex returns the index of the LogLinear bucket which `value`
+  // falls into, where the bucket with index i counts values in [L(i), L(i+1))
+  // and L(i) is the i-th boundary of the sequence beginning at zero. It is
+  // computed from the number of leading zeros of `value`.
+  static uint64_t LogLinearIndex(uint64_t value, uint32_t significant_bits);
+
   bool operator==(BucketsCalculator other) const;
 
   bool operator!=(BucketsCalculator other) const;
@@ -43,6 +81,19 @@ class BucketsCalculator {
   const Growth growth_;
   const double start_;
   const double update_;
+
+  // Reciprocals precomputed so that Index multiplies rather than divides. For
+  // linear growth `inverse_update_` is the reciprocal of the width and for
+  // exponential growth it is the reciprocal of the base two logarithm of the
+  // factor.
+  const double inverse_start_;
+  const double inverse_update_;
+
+  // The number of significant bits of a LogLinear calculator.
+  const uint32_t significant_bits_;
+
+  // The bounds of an Explicit calculator, which is null for other growths.
+  const std::shared_ptr<const std::vector<double>> bounds_;
 };
 
 }  // namespace tally
@@ -0,0 +1,55 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tally {
+
+// CACHE_LINE_SIZE is the assumed size of a CPU cache line. State written by
+// different threads is kept at least this far apart to avoid false sharing.
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ThreadIndex returns a small integer which is unique to the calling thread
+// for the lifetime of the process. Indices are handed out in the order threads
+// first call the function so that consecutive threads map to different
+// stripes of a striped metric.
+inline uint32_t ThreadIndex() noexcept {
+  static std::atomic<uint32_t> next_index(0);
+  thread_local uint32_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+// RoundUpToPowerOfTwo returns the smallest power of two which is greater than
+// or equal to `value`, or 1 if `value` is zero. Values above 2^31 are clamped
+// to 2^31.
+inline uint32_t RoundUpToPowerOfTwo(uint32_t value) noexcept {
+  uint32_t result = 1;
+  while (result < value && result < (uint32_t(1) << 31)) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace tally
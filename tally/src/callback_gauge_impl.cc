@@ -0,0 +1,50 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/callback_gauge_impl.h"
+
+#include <string>
+#include <utility>
+
+namespace tally {
+
+CallbackGaugeImpl::CallbackGaugeImpl(std::function<double()> callback) noexcept
+    : callback_(std::move(callback)) {}
+
+void CallbackGaugeImpl::Report(const std::string &name, const TagSet &tags,
+                               StatsReporter *reporter) {
+  if (!callback_ || reporter == nullptr) {
+    return;
+  }
+
+  // The callback is user code running on the reporting thread, so an
+  // exception it throws must not escape and stop the other metrics from being
+  // reported.
+  double value;
+  try {
+    value = callback_();
+  } catch (...) {
+    return;
+  }
+
+  reporter->ReportGauge(name, tags, value);
+}
+
+}  // namespace tally
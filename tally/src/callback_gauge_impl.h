@@ -0,0 +1,52 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
+
+namespace tally {
+
+// CallbackGaugeImpl is a gauge whose value is pulled from a callback when it
+// is reported rather than pushed on every change, so there is no cost to
+// keeping it up to date between reports.
+class CallbackGaugeImpl {
+ public:
+  explicit CallbackGaugeImpl(std::function<double()> callback) noexcept;
+
+  // Ensure the class is non-copyable.
+  CallbackGaugeImpl(const CallbackGaugeImpl &) = delete;
+
+  CallbackGaugeImpl &operator=(const CallbackGaugeImpl &) = delete;
+
+  // Report invokes the callback and reports the value it returns, or nothing if
+  // the callback throws. It must only be called from a single thread.
+  void Report(const std::string &name, const TagSet &tags,
+              StatsReporter *reporter);
+
+ private:
+  const std::function<double()> callback_;
+};
+
+}  // namespace tally
@@ -22,11 +22,15 @@
 
 namespace tally {
 
-CapableOf::CapableOf(bool reporting, bool tagging)
-    : reporting_(reporting), tagging_(tagging) {}
+CapableOf::CapableOf(bool reporting, bool tagging, bool aggregated_timers)
+    : reporting_(reporting),
+      tagging_(tagging),
+      aggregated_timers_(aggregated_timers) {}
 
 bool CapableOf::Reporting() const { return reporting_; }
 
 bool CapableOf::Tagging() const { return tagging_; }
 
+bool CapableOf::AggregatedTimers() const { return aggregated_timers_; }
+
 }  // namespace tally
@@ -26,16 +26,19 @@ namespace tally {
 
 class CapableOf : public Capabilities {
  public:
-  CapableOf(bool reporting, bool tagging);
+  CapableOf(bool reporting, bool tagging, bool aggregated_timers);
 
   // Methods to implement the Capabilities interface.
   bool Reporting() const;
 
   bool Tagging() const;
 
+  bool AggregatedTimers() const;
+
  private:
   const bool reporting_;
   const bool tagging_;
+  const bool aggregated_timers_;
 };
 
 }  // namespace tally
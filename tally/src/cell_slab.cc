@@ -0,0 +1,66 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/cell_slab.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace tally {
+
+namespace {
+const std::size_t DEFAULT_CHUNK_LINES = 64;
+}  // namespace
+
+CellSlab::CellSlab(std::size_t chunk_lines) noexcept
+    : chunk_lines_(chunk_lines), next_(nullptr), remaining_lines_(0) {}
+
+std::shared_ptr<CellSlab> CellSlab::New() noexcept {
+  return std::make_shared<CellSlab>(DEFAULT_CHUNK_LINES);
+}
+
+void *CellSlab::Allocate(std::size_t lines) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (lines > remaining_lines_) {
+    // Requests larger than a chunk get a chunk of their own. Any space left in
+    // the current chunk is abandoned when a new one is started.
+    auto const chunk_lines = lines > chunk_lines_ ? lines : chunk_lines_;
+
+    // Over-allocate by a cache line so the chunk can be aligned to a cache
+    // line boundary regardless of where the storage was placed.
+    std::unique_ptr<char[]> chunk(
+        new char[chunk_lines * CACHE_LINE_SIZE + CACHE_LINE_SIZE]());
+    auto const address = reinterpret_cast<uintptr_t>(chunk.get());
+    auto const aligned =
+        (address + CACHE_LINE_SIZE - 1) & ~(uintptr_t(CACHE_LINE_SIZE) - 1);
+
+    next_ = reinterpret_cast<char *>(aligned);
+    remaining_lines_ = chunk_lines;
+    chunks_.push_back(std::move(chunk));
+  }
+
+  auto const allocation = next_;
+  next_ += lines * CACHE_LINE_SIZE;
+  remaining_lines_ -= lines;
+  return allocation;
+}
+
+}  // namespace tally
@@ -0,0 +1,64 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "tally/src/cache_line.h"
+
+namespace tally {
+
+// CellSlab allocates cache-line-aligned storage for the parts of metrics which
+// are written on the hot path. Storage is carved out of larger chunks so that
+// a Scope's metrics are packed densely in memory while every allocation still
+// begins on its own cache line, which prevents unrelated metrics from falsely
+// sharing a line. Storage is only released when the slab is destroyed, so
+// metrics which allocate from a slab must hold a reference to it.
+class CellSlab {
+ public:
+  // Constructs a slab which allocates chunks of `chunk_lines` cache lines.
+  explicit CellSlab(std::size_t chunk_lines) noexcept;
+
+  // Ensure the class is non-copyable.
+  CellSlab(const CellSlab &) = delete;
+
+  CellSlab &operator=(const CellSlab &) = delete;
+
+  // New returns a slab with the default chunk size, suitable for a Scope.
+  static std::shared_ptr<CellSlab> New() noexcept;
+
+  // Allocate returns zeroed storage spanning `lines` consecutive cache lines.
+  // It is safe to call from multiple threads.
+  void *Allocate(std::size_t lines);
+
+ private:
+  const std::size_t chunk_lines_;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  char *next_;
+  std::size_t remaining_lines_;
+};
+
+}  // namespace tally
@@ -0,0 +1,147 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/clock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace tally {
+
+namespace {
+
+// The length of time the TSC's rate is measured over. Longer calibrations are
+// more accurate but delay the first selection of the TSC.
+const std::chrono::milliseconds CALIBRATION_PERIOD =
+    std::chrono::milliseconds(20);
+
+using NowFunction = std::chrono::steady_clock::time_point (*)();
+
+std::chrono::steady_clock::time_point SteadyNow() {
+  return std::chrono::steady_clock::now();
+}
+
+#if defined(__x86_64__)
+
+// TSCCalibration maps readings of the TSC onto steady_clock time points by
+// pairing a reading of each taken at the same instant with the number of
+// nanoseconds per tick of the TSC.
+struct TSCCalibration {
+  bool reliable;
+  uint64_t base_ticks;
+  std::chrono::steady_clock::time_point base_time;
+  double nanoseconds_per_tick;
+};
+
+// InvariantTSC returns whether the processor advertises that its TSC ticks at
+// a constant rate in every power state, without which it cannot be used as a
+// clock.
+bool InvariantTSC() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 ||
+      eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return (edx & (1u << 8)) != 0;
+}
+
+TSCCalibration Calibrate() {
+  TSCCalibration calibration{false, 0, std::chrono::steady_clock::now(), 0};
+  if (!InvariantTSC()) {
+    return calibration;
+  }
+
+  auto const start_time = std::chrono::steady_clock::now();
+  auto const start_ticks = __rdtsc();
+  std::this_thread::sleep_for(CALIBRATION_PERIOD);
+  auto const end_time = std::chrono::steady_clock::now();
+  auto const end_ticks = __rdtsc();
+
+  // A TSC which did not advance, e.g. because the hypervisor traps and fakes
+  // it, is no use as a clock.
+  auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      end_time - start_time);
+  if (end_ticks <= start_ticks || elapsed.count() <= 0) {
+    return calibration;
+  }
+
+  calibration.reliable = true;
+  calibration.base_ticks = end_ticks;
+  calibration.base_time = end_time;
+  calibration.nanoseconds_per_tick =
+      static_cast<double>(elapsed.count()) /
+      static_cast<double>(end_ticks - start_ticks);
+  return calibration;
+}
+
+const TSCCalibration &Calibration() {
+  static const TSCCalibration calibration = Calibrate();
+  return calibration;
+}
+
+std::chrono::steady_clock::time_point TSCNow() {
+  auto const &calibration = Calibration();
+  auto const ticks = static_cast<int64_t>(__rdtsc() - calibration.base_ticks);
+  return calibration.base_time +
+         std::chrono::nanoseconds(static_cast<int64_t>(
+             static_cast<double>(ticks) * calibration.nanoseconds_per_tick));
+}
+
+#endif
+
+std::atomic<NowFunction> now_function(&SteadyNow);
+
+}  // namespace
+
+std::chrono::steady_clock::time_point Clock::Now() noexcept {
+  return now_function.load(std::memory_order_relaxed)();
+}
+
+bool Clock::Use(Source source) noexcept {
+  switch (source) {
+    case Source::Steady:
+      now_function.store(&SteadyNow, std::memory_order_relaxed);
+      return true;
+    case Source::TSC:
+#if defined(__x86_64__)
+      if (Calibration().reliable) {
+        now_function.store(&TSCNow, std::memory_order_relaxed);
+        return true;
+      }
+#endif
+      return false;
+  }
+  return false;
+}
+
+Clock::Source Clock::source() noexcept {
+  return now_function.load(std::memory_order_relaxed) == &SteadyNow
+             ? Source::Steady
+             : Source::TSC;
+}
+
+}  // namespace tally
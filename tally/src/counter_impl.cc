@@ -18,26 +18,49 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <cstdint>
+#include <new>
 #include <string>
+#include <utility>
 
 #include "tally/src/counter_impl.h"
 
 namespace tally {
 
+CounterImpl::CounterImpl() noexcept : CounterImpl(1) {}
+
+CounterImpl::CounterImpl(uint32_t stripes) noexcept
+    : CounterImpl(stripes, nullptr) {}
+
 // cppcheck reports a false positive error that previous is not initialized.
 //
 // cppcheck-suppress uninitMemberVar
-CounterImpl::CounterImpl() noexcept : previous_(0), current_(0) {}
+CounterImpl::CounterImpl(uint32_t stripes,
+                         std::shared_ptr<CellSlab> slab) noexcept
+    : previous_(0),
+      mask_(RoundUpToPowerOfTwo(stripes) - 1),
+      slab_(slab == nullptr ? std::make_shared<CellSlab>(mask_ + 1)
+                            : std::move(slab)),
+      cells_(static_cast<Cell *>(slab_->Allocate(mask_ + 1))),
+      detached_(0) {
+  for (uint32_t i = 0; i <= mask_; i++) {
+    new (&cells_[i]) Cell();
+    cells_[i].value.store(0, std::memory_order_relaxed);
+  }
+}
 
 void CounterImpl::Inc() noexcept { Inc(1); }
 
-void CounterImpl::Inc(int64_t delta) noexcept { current_ += delta; }
+void CounterImpl::Inc(int64_t delta) noexcept {
+  // Every cell is only ever summed, never reset, so increments can use relaxed
+  // ordering. With a single cell the index is always zero.
+  cells_[ThreadIndex() & mask_].value.fetch_add(delta,
+                                                std::memory_order_relaxed);
+}
 
-void CounterImpl::Report(
-    const std::string &name,
-    const std::unordered_map<std::string, std::string> &tags,
-    StatsReporter *reporter) {
+void CounterImpl::Report(const std::string &name, const TagSet &tags,
+                         StatsReporter *reporter) {
   auto const val = Value();
   if (val != 0 && reporter != nullptr) {
     reporter->ReportCounter(name, tags, val);
@@ -45,10 +68,35 @@ void CounterImpl::Report(
 }
 
 int64_t CounterImpl::Value() {
-  const auto current = current_.load();
+  int64_t current = 0;
+  for (uint32_t i = 0; i <= mask_; i++) {
+    current += cells_[i].value.load(std::memory_order_relaxed);
+  }
+  {
+    std::lock_guard<std::mutex> lock(local_cells_mutex_);
+    current += detached_;
+    for (auto const cell : local_cells_) {
+      current += cell->load(std::memory_order_relaxed);
+    }
+  }
   const auto previous = previous_;
   previous_ = current;
   return current - previous;
 }
 
+void CounterImpl::Attach(const std::atomic<int64_t> *cell) {
+  std::lock_guard<std::mutex> lock(local_cells_mutex_);
+  local_cells_.push_back(cell);
+}
+
+void CounterImpl::Detach(const std::atomic<int64_t> *cell) {
+  std::lock_guard<std::mutex> lock(local_cells_mutex_);
+  auto it = std::find(local_cells_.begin(), local_cells_.end(), cell);
+  if (it == local_cells_.end()) {
+    return;
+  }
+  detached_ += cell->load(std::memory_order_relaxed);
+  local_cells_.erase(it);
+}
+
 }  // namespace tally
@@ -22,12 +22,16 @@
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "tally/counter.h"
+#include "tally/src/cache_line.h"
+#include "tally/src/cell_slab.h"
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
@@ -35,6 +39,16 @@ class CounterImpl : public Counter {
  public:
   CounterImpl() noexcept;
 
+  // Constructs a striped counter whose increments are spread across `stripes`
+  // cells, each on its own cache line, so that threads incrementing the
+  // counter concurrently do not contend with one another. The number of
+  // stripes is rounded up to the nearest power of two.
+  explicit CounterImpl(uint32_t stripes) noexcept;
+
+  // Constructs a striped counter whose cells are allocated from `slab`. If
+  // `slab` is null the counter allocates its cells from a slab of its own.
+  CounterImpl(uint32_t stripes, std::shared_ptr<CellSlab> slab) noexcept;
+
   // Ensure the class is non-copyable.
   CounterImpl(const CounterImpl &) = delete;
 
@@ -47,17 +61,41 @@ class CounterImpl : public Counter {
 
   // Report reports the current value of the counter. It must only be called
   // from a single thread.
-  void Report(const std::string &name,
-              const std::unordered_map<std::string, std::string> &tags,
+  void Report(const std::string &name, const TagSet &tags,
               StatsReporter *reporter);
 
   // Value returns the current value of the counter. It must only be called from
   // a single thread.
   int64_t Value();
 
+  // Attach registers a cell owned by a thread-local handle to the counter so
+  // that the cell is included in the counter's value until it is detached.
+  void Attach(const std::atomic<int64_t> *cell);
+
+  // Detach folds the value of a previously attached cell into the counter and
+  // stops reading it. The cell must not be written to after it is detached.
+  void Detach(const std::atomic<int64_t> *cell);
+
  private:
+  // Cell holds a portion of the counter's value. Each cell is padded to fill a
+  // whole cache line.
+  struct alignas(CACHE_LINE_SIZE) Cell {
+    std::atomic<int64_t> value;
+  };
+
+  static_assert(sizeof(Cell) == CACHE_LINE_SIZE,
+                "Counter cells must occupy exactly one cache line");
+
+  // The cells are written by any thread incrementing the counter and live in
+  // the slab, whereas the remaining state is only accessed when reporting.
   int64_t previous_;
-  std::atomic<int64_t> current_;
+  const uint32_t mask_;
+  std::shared_ptr<CellSlab> slab_;
+  Cell *cells_;
+
+  std::mutex local_cells_mutex_;
+  int64_t detached_;
+  std::vector<const std::atomic<int64_t> *> local_cells_;
 };
 
 }  // namespace tally
@@ -0,0 +1,269 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/dd_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace tally {
+
+DDSketch::DDSketch(double relative_accuracy, std::size_t max_buckets)
+    : gamma_((1 + relative_accuracy) / (1 - relative_accuracy)),
+      inverse_log_gamma_(1 / std::log(gamma_)),
+      min_indexable_(std::numeric_limits<double>::min() * gamma_),
+      min_index_(0),
+      max_index_(0),
+      max_buckets_(max_buckets),
+      zero_count_(0),
+      count_(0) {
+  if (!(relative_accuracy > 0 && relative_accuracy < 1)) {
+    throw std::invalid_argument("Relative accuracy must lie in (0, 1)");
+  }
+
+  if (max_buckets == 0) {
+    throw std::invalid_argument("Maximum number of buckets cannot be zero");
+  }
+
+  // Bucket indices and the differences between them are held in 32 bits, so
+  // the accuracy must not be so fine that the range of doubles spans more
+  // indices than that.
+  auto const lowest =
+      std::ceil(std::log(min_indexable_) * inverse_log_gamma_);
+  auto const highest = std::ceil(
+      std::log(std::numeric_limits<double>::max()) * inverse_log_gamma_);
+  if (!(highest - lowest + 2 <=
+        static_cast<double>(std::numeric_limits<int32_t>::max()))) {
+    throw std::invalid_argument(
+        "Relative accuracy is too fine to index every double");
+  }
+
+  min_index_ = static_cast<int32_t>(lowest);
+  max_index_ = static_cast<int32_t>(highest);
+}
+
+void DDSketch::Reserve() {
+  positive_.counts.reserve(max_buckets_);
+  negative_.counts.reserve(max_buckets_);
+}
+
+void DDSketch::Add(double value, uint64_t count) noexcept {
+  if (std::isnan(value) || count == 0) {
+    return;
+  }
+
+  auto const magnitude = std::abs(value);
+  if (magnitude < min_indexable_) {
+    zero_count_ += count;
+  } else {
+    Add(value > 0 ? &positive_ : &negative_, Index(magnitude), count);
+  }
+  count_ += count;
+}
+
+bool DDSketch::PositiveIndex(double value, int32_t *index) const noexcept {
+  // NaN fails the comparison too.
+  if (!(value >= min_indexable_)) {
+    return false;
+  }
+  *index = Index(value);
+  return true;
+}
+
+void DDSketch::AddPositive(int32_t index, uint64_t count) noexcept {
+  if (count == 0) {
+    return;
+  }
+  Add(&positive_, index, count);
+  count_ += count;
+}
+
+void DDSketch::Merge(const DDSketch &other) {
+  if (gamma_ != other.gamma_) {
+    throw std::invalid_argument(
+        "Cannot merge sketches with different relative accuracies");
+  }
+
+  for (std::size_t i = 0; i < other.positive_.counts.size(); i++) {
+    if (other.positive_.counts[i] != 0) {
+      Add(&positive_, other.positive_.offset + static_cast<int32_t>(i),
+          other.positive_.counts[i]);
+    }
+  }
+
+  for (std::size_t i = 0; i < other.negative_.counts.size(); i++) {
+    if (other.negative_.counts[i] != 0) {
+      Add(&negative_, other.negative_.offset + static_cast<int32_t>(i),
+          other.negative_.counts[i]);
+    }
+  }
+
+  zero_count_ += other.zero_count_;
+  count_ += other.count_;
+}
+
+void DDSketch::Clear() noexcept {
+  positive_.counts.clear();
+  negative_.counts.clear();
+  zero_count_ = 0;
+  count_ = 0;
+}
+
+double DDSketch::Quantile(double quantile) const noexcept {
+  if (count_ == 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  // The estimate is the value of the bucket holding the value with the rank
+  // of the quantile, walking the buckets in ascending order of value.
+  auto const rank = quantile * static_cast<double>(count_ - 1);
+  uint64_t seen = 0;
+
+  for (auto i = negative_.counts.size(); i > 0; i--) {
+    seen += negative_.counts[i - 1];
+    if (static_cast<double>(seen) > rank) {
+      return -Value(negative_.offset + static_cast<int32_t>(i - 1));
+    }
+  }
+
+  seen += zero_count_;
+  if (static_cast<double>(seen) > rank) {
+    return 0;
+  }
+
+  for (std::size_t i = 0; i < positive_.counts.size(); i++) {
+    seen += positive_.counts[i];
+    if (static_cast<double>(seen) > rank) {
+      return Value(positive_.offset + static_cast<int32_t>(i));
+    }
+  }
+
+  // Only reachable for quantiles greater than one.
+  if (!positive_.counts.empty()) {
+    return Value(positive_.offset +
+                 static_cast<int32_t>(positive_.counts.size() - 1));
+  }
+  return zero_count_ != 0 ? 0 : -Value(negative_.offset);
+}
+
+uint64_t DDSketch::NumBucketIDs() const noexcept {
+  auto const num_indices = static_cast<uint64_t>(max_index_ - min_index_ + 1);
+  return 2 * num_indices + 1;
+}
+
+void DDSketch::ForEachBucket(
+    const std::function<void(uint64_t, double, double, uint64_t)> &fn) const {
+  // IDs are assigned to negative buckets from the most negative, then to the
+  // zero bucket, and then to positive buckets from the least positive.
+  auto const zero_id = static_cast<uint64_t>(max_index_ - min_index_ + 1);
+
+  for (auto i = negative_.counts.size(); i > 0; i--) {
+    auto const count = negative_.counts[i - 1];
+    if (count != 0) {
+      auto const index = negative_.offset + static_cast<int32_t>(i - 1);
+      fn(static_cast<uint64_t>(max_index_ - index), -LowerBound(index + 1),
+         -LowerBound(index), count);
+    }
+  }
+
+  if (zero_count_ != 0) {
+    fn(zero_id, -min_indexable_, min_indexable_, zero_count_);
+  }
+
+  for (std::size_t i = 0; i < positive_.counts.size(); i++) {
+    auto const count = positive_.counts[i];
+    if (count != 0) {
+      auto const index = positive_.offset + static_cast<int32_t>(i);
+      fn(zero_id + 1 + static_cast<uint64_t>(index - min_index_),
+         LowerBound(index), LowerBound(index + 1), count);
+    }
+  }
+}
+
+int32_t DDSketch::Index(double magnitude) const noexcept {
+  // Magnitudes beyond the largest finite double share its bucket.
+  auto const index = std::ceil(std::log(magnitude) * inverse_log_gamma_);
+  if (std::isinf(index)) {
+    return max_index_;
+  }
+  return static_cast<int32_t>(index);
+}
+
+double DDSketch::LowerBound(int32_t index) const noexcept {
+  // The upper bound of the highest bucket would overflow.
+  return std::min(std::pow(gamma_, static_cast<double>(index - 1)),
+                  std::numeric_limits<double>::max());
+}
+
+double DDSketch::Value(int32_t index) const noexcept {
+  return LowerBound(index) * 2 * gamma_ / (1 + gamma_);
+}
+
+void DDSketch::Add(Store *store, int32_t index, uint64_t count) noexcept {
+  auto &counts = store->counts;
+  if (counts.empty()) {
+    store->offset = index;
+    counts.assign(1, count);
+    return;
+  }
+
+  auto const max_buckets = static_cast<int64_t>(max_buckets_);
+  auto const low = static_cast<int64_t>(store->offset);
+  auto const high = low + static_cast<int64_t>(counts.size()) - 1;
+
+  if (index > high) {
+    auto const new_low = std::max(low, index - max_buckets + 1);
+    if (new_low != low) {
+      // Collapse the buckets which no longer fit into the lowest bucket which
+      // does. This is done in place so that a reserved store never
+      // reallocates.
+      auto const collapsed =
+          static_cast<std::size_t>(std::min(new_low, high) - low);
+      uint64_t total = 0;
+      for (std::size_t i = 0; i <= collapsed; i++) {
+        total += counts[i];
+      }
+      counts.erase(counts.begin(),
+                   counts.begin() + static_cast<std::ptrdiff_t>(collapsed));
+      counts[0] = total;
+      store->offset = static_cast<int32_t>(new_low);
+    }
+    counts.resize(static_cast<std::size_t>(index - new_low + 1), 0);
+  } else if (index < low) {
+    // Values whose bucket is too far below the highest bucket are collapsed
+    // into the lowest bucket which fits.
+    auto const new_low = std::max(static_cast<int64_t>(index),
+                                  high - max_buckets + 1);
+    if (new_low < low) {
+      counts.insert(counts.begin(), static_cast<std::size_t>(low - new_low), 0);
+      store->offset = static_cast<int32_t>(new_low);
+    }
+    index = std::max(index, store->offset);
+  }
+
+  counts[static_cast<std::size_t>(index - store->offset)] += count;
+}
+
+}  // namespace tally
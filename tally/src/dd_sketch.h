@@ -0,0 +1,128 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tally {
+
+// DDSketch is a mergeable quantile sketch with relative-error guarantees. It
+// counts values in logarithmically sized buckets, so that every value in a
+// bucket is within the relative accuracy of the bucket's representative value,
+// and so that any quantile it estimates is within the relative accuracy of the
+// true quantile. Positive and negative values are counted in separate stores
+// of buckets. When a store would exceed the maximum number of buckets, its
+// buckets closest to zero are collapsed into one, which bounds memory while
+// preserving the accuracy of the tails.
+//
+// DDSketch is not thread-safe.
+class DDSketch {
+ public:
+  // DDSketch constructs an empty sketch which estimates quantiles to within
+  // `relative_accuracy`, which must lie in (0, 1), and keeps at most
+  // `max_buckets` buckets for each of its positive and negative values. Throws
+  // std::invalid_argument if the accuracy is finer than about 3.3e-7, beyond
+  // which the bucket indices of doubles no longer fit in 32 bits.
+  DDSketch(double relative_accuracy, std::size_t max_buckets);
+
+  // Reserve allocates the maximum number of buckets of each store up front,
+  // after which counting values never allocates.
+  void Reserve();
+
+  // Add counts `value` `count` times. It may allocate unless the sketch has
+  // been reserved.
+  void Add(double value, uint64_t count = 1) noexcept;
+
+  // PositiveIndex sets `index` to the index of the bucket which counts `value`
+  // and returns true if `value` is positive and not counted as zero, or
+  // returns false otherwise. It only reads state which is fixed on
+  // construction, so it may be called concurrently with any other method.
+  bool PositiveIndex(double value, int32_t *index) const noexcept;
+
+  // AddPositive adds `count` to the bucket with the positive value index
+  // `index`, which must have been returned by PositiveIndex.
+  void AddPositive(int32_t index, uint64_t count) noexcept;
+
+  // Merge adds the counts of `other`, which must have been constructed with
+  // the same relative accuracy, to the sketch.
+  void Merge(const DDSketch &other);
+
+  // Clear removes every count from the sketch.
+  void Clear() noexcept;
+
+  // Quantile returns an estimate of the `quantile`, which must lie in [0, 1],
+  // of the counted values. It returns NaN if the sketch is empty.
+  double Quantile(double quantile) const noexcept;
+
+  // Count returns the total number of values counted.
+  uint64_t Count() const noexcept { return count_; }
+
+  // NumBucketIDs returns the number of distinct IDs which ForEachBucket may
+  // pass. IDs are stable across sketches with the same relative accuracy.
+  uint64_t NumBucketIDs() const noexcept;
+
+  // ForEachBucket calls `fn` with the ID, lower bound, upper bound and count of
+  // each non-empty bucket in ascending order of value.
+  void ForEachBucket(
+      const std::function<void(uint64_t, double, double, uint64_t)> &fn) const;
+
+ private:
+  // Store is a contiguous range of bucket counts indexed by the logarithm of
+  // the magnitude of the values they count.
+  struct Store {
+    int32_t offset = 0;
+    std::vector<uint64_t> counts;
+  };
+
+  // Index returns the index of the bucket which counts values of magnitude
+  // `magnitude`, which must be at least `min_indexable_`.
+  int32_t Index(double magnitude) const noexcept;
+
+  // LowerBound returns the exclusive lower bound of the magnitudes counted by
+  // the bucket with index `index`, which is also the inclusive upper bound of
+  // the bucket below it.
+  double LowerBound(int32_t index) const noexcept;
+
+  // Value returns the representative magnitude of the bucket with index
+  // `index`, which is within the relative accuracy of every magnitude in it.
+  double Value(int32_t index) const noexcept;
+
+  // Add adds `count` to the bucket with index `index` of `store`, collapsing
+  // the buckets with the lowest indices if necessary.
+  void Add(Store *store, int32_t index, uint64_t count) noexcept;
+
+  double gamma_;
+  double inverse_log_gamma_;
+  double min_indexable_;
+  int32_t min_index_;
+  int32_t max_index_;
+  std::size_t max_buckets_;
+
+  Store positive_;
+  Store negative_;
+  uint64_t zero_count_;
+  uint64_t count_;
+};
+
+}  // namespace tally
@@ -18,27 +18,98 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <string>
+#include <utility>
 
 #include "tally/src/gauge_impl.h"
 
 namespace tally {
 
-GaugeImpl::GaugeImpl() noexcept : current_(0), updated_(false) {}
+GaugeImpl::GaugeImpl() noexcept : GaugeImpl(Aggregation::Last) {}
+
+GaugeImpl::GaugeImpl(Aggregation aggregation) noexcept
+    : GaugeImpl(aggregation, nullptr) {}
+
+GaugeImpl::GaugeImpl(Aggregation aggregation,
+                     std::shared_ptr<CellSlab> slab) noexcept
+    : aggregation_(aggregation),
+      slab_(slab == nullptr ? std::make_shared<CellSlab>(1) : std::move(slab)),
+      cell_(new (slab_->Allocate(1)) Cell()) {
+  cell_->current.store(aggregation_ == Aggregation::Last ? 0 : Empty());
+  cell_->updated.store(false);
+}
 
 void GaugeImpl::Update(double value) noexcept {
-  current_ = value;
-  updated_ = true;
+  if (aggregation_ == Aggregation::Last) {
+    cell_->current = value;
+    cell_->updated = true;
+    return;
+  }
+
+  // Leaving the cell untouched when the combined value is unchanged avoids
+  // dirtying the cache line, which is the common case for Max and Min.
+  auto current = cell_->current.load(std::memory_order_relaxed);
+  while (true) {
+    auto const next = Combine(current, value);
+    if (SameBits(next, current) ||
+        cell_->current.compare_exchange_weak(current, next)) {
+      return;
+    }
+  }
 }
 
-void GaugeImpl::Report(const std::string &name,
-                       const std::unordered_map<std::string, std::string> &tags,
+void GaugeImpl::Report(const std::string &name, const TagSet &tags,
                        StatsReporter *reporter) {
-  bool expected = true;
-  if (updated_.compare_exchange_strong(expected, false) &&
-      reporter != nullptr) {
-    reporter->ReportGauge(name, tags, current_);
+  double value;
+  if (aggregation_ == Aggregation::Last) {
+    bool expected = true;
+    if (!cell_->updated.compare_exchange_strong(expected, false)) {
+      return;
+    }
+    value = cell_->current;
+  } else {
+    // Resetting the cell to the empty marker in the same operation that reads
+    // the aggregated value means an update racing with the report is either
+    // included in the value reported or starts the next interval.
+    value = cell_->current.exchange(Empty());
+    if (SameBits(value, Empty())) {
+      return;
+    }
+  }
+
+  if (reporter != nullptr) {
+    reporter->ReportGauge(name, tags, value);
   }
 }
 
+double GaugeImpl::Combine(double current, double value) const noexcept {
+  if (SameBits(current, Empty())) {
+    return value;
+  }
+
+  switch (aggregation_) {
+    case Aggregation::Max:
+      return value > current ? value : current;
+    case Aggregation::Min:
+      return value < current ? value : current;
+    default:
+      return current + value;
+  }
+}
+
+double GaugeImpl::Empty() noexcept {
+  // A quiet NaN with a payload which arithmetic on updates does not produce.
+  static const uint64_t bits = 0x7FF80000DEADBEEF;
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+bool GaugeImpl::SameBits(double a, double b) noexcept {
+  return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
 }  // namespace tally
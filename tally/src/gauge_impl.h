@@ -21,11 +21,14 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <string>
-#include <unordered_map>
 
 #include "tally/gauge.h"
+#include "tally/src/cache_line.h"
+#include "tally/src/cell_slab.h"
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
@@ -33,6 +36,14 @@ class GaugeImpl : public Gauge {
  public:
   GaugeImpl() noexcept;
 
+  // Constructs a gauge which combines the updates made to it within a
+  // reporting interval using `aggregation`.
+  explicit GaugeImpl(Aggregation aggregation) noexcept;
+
+  // Constructs a gauge whose state is allocated from `slab`. If `slab` is null
+  // the gauge allocates its state from a slab of its own.
+  GaugeImpl(Aggregation aggregation, std::shared_ptr<CellSlab> slab) noexcept;
+
   // Ensure the class is non-copyable.
   GaugeImpl(const GaugeImpl &) = delete;
 
@@ -41,14 +52,38 @@ class GaugeImpl : public Gauge {
   // Methods to implement the Gauge interface.
   void Update(double) noexcept;
 
-  // Report reports the current value of the Gauge.
-  void Report(const std::string &name,
-              const std::unordered_map<std::string, std::string> &tags,
+  // Report reports the current value of the Gauge if it has been updated since
+  // it was last reported, and resets the aggregated value.
+  void Report(const std::string &name, const TagSet &tags,
               StatsReporter *reporter);
 
  private:
-  std::atomic<double> current_;
-  std::atomic_bool updated_;
+  // Cell holds the state of the gauge, which is written on every update, on a
+  // cache line of its own. Aggregated gauges hold the empty marker in
+  // `current` until they are first updated within an interval, so only gauges
+  // with the Last aggregation use `updated`.
+  struct alignas(CACHE_LINE_SIZE) Cell {
+    std::atomic<double> current;
+    std::atomic_bool updated;
+  };
+
+  static_assert(sizeof(Cell) == CACHE_LINE_SIZE,
+                "Gauge cells must occupy exactly one cache line");
+
+  // Combine returns the result of aggregating `value` into `current`.
+  double Combine(double current, double value) const noexcept;
+
+  // Empty returns the marker an aggregated gauge is reset to when reported,
+  // which distinguishes an interval without updates from any value reported.
+  static double Empty() noexcept;
+
+  // SameBits returns whether two doubles have the same representation, which
+  // unlike == holds for NaNs.
+  static bool SameBits(double a, double b) noexcept;
+
+  const Aggregation aggregation_;
+  std::shared_ptr<CellSlab> slab_;
+  Cell *cell_;
 };
 
 }  // namespace tally
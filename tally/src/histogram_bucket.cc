@@ -20,12 +20,25 @@
 
 #include "tally/src/histogram_bucket.h"
 
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <string>
-#include <unordered_map>
-#include <vector>
 
 namespace tally {
 
+std::chrono::nanoseconds HistogramBucket::ToNanoseconds(double bound) {
+  auto const max = static_cast<double>(std::numeric_limits<int64_t>::max());
+  auto const min = static_cast<double>(std::numeric_limits<int64_t>::min());
+  if (bound >= max) {
+    return std::chrono::nanoseconds(std::numeric_limits<int64_t>::max());
+  }
+  if (bound <= min) {
+    return std::chrono::nanoseconds(std::numeric_limits<int64_t>::min());
+  }
+  return std::chrono::nanoseconds(static_cast<int64_t>(bound));
+}
+
 HistogramBucket::HistogramBucket(Buckets::Kind kind, uint64_t bucket_id,
                                  uint64_t num_buckets, double lower_bound,
                                  double upper_bound)
@@ -34,26 +47,31 @@ HistogramBucket::HistogramBucket(Buckets::Kind kind, uint64_t bucket_id,
       num_buckets_(num_buckets),
       lower_bound_(lower_bound),
       upper_bound_(upper_bound),
-      samples_(new CounterImpl()) {}
+      lower_duration_(ToNanoseconds(lower_bound)),
+      upper_duration_(ToNanoseconds(upper_bound)) {}
 
-void HistogramBucket::Record() { samples_->Inc(1); }
+HistogramBucket::HistogramBucket(uint64_t bucket_id, uint64_t num_buckets,
+                                 std::chrono::nanoseconds lower_bound,
+                                 std::chrono::nanoseconds upper_bound)
+    : kind_(Buckets::Kind::Durations),
+      bucket_id_(bucket_id),
+      num_buckets_(num_buckets),
+      lower_bound_(static_cast<double>(lower_bound.count())),
+      upper_bound_(static_cast<double>(upper_bound.count())),
+      lower_duration_(lower_bound),
+      upper_duration_(upper_bound) {}
 
-void HistogramBucket::Report(
-    const std::string &name,
-    const std::unordered_map<std::string, std::string> &tags,
-    StatsReporter *reporter) {
-  auto samples = samples_->Value();
+void HistogramBucket::Report(const std::string &name, const TagSet &tags,
+                             uint64_t samples, StatsReporter *reporter) const {
   if (samples != 0 && reporter != nullptr) {
     if (kind_ == Buckets::Kind::Values) {
       reporter->ReportHistogramValueSamples(name, tags, bucket_id_,
                                             num_buckets_, lower_bound_,
                                             upper_bound_, samples);
     } else {
-      reporter->ReportHistogramDurationSamples(
-          name, tags, bucket_id_, num_buckets_,
-          std::chrono::nanoseconds(static_cast<int64_t>(lower_bound_)),
-          std::chrono::nanoseconds(static_cast<int64_t>(upper_bound_)),
-          samples);
+      reporter->ReportHistogramDurationSamples(name, tags, bucket_id_,
+                                               num_buckets_, lower_duration_,
+                                               upper_duration_, samples);
     }
   }
 }
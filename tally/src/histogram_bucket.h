@@ -20,24 +20,37 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
-#include <vector>
 
 #include "tally/buckets.h"
-#include "tally/src/counter_impl.h"
+#include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
+// HistogramBucket is a view of a single bucket of a histogram which is used to
+// report the number of samples recorded in the bucket. The samples themselves
+// are counted by the histogram.
 class HistogramBucket {
  public:
   HistogramBucket(Buckets::Kind kind, uint64_t bucket_id, uint64_t num_buckets,
                   double lower_bound, double upper_bound);
 
-  void Record();
-  void Report(const std::string &name,
-              const std::unordered_map<std::string, std::string> &tags,
-              StatsReporter *reporter);
+  // HistogramBucket constructs a view of a Duration bucket from bounds which
+  // are already in nanoseconds, so reporting it needs no conversion.
+  HistogramBucket(uint64_t bucket_id, uint64_t num_buckets,
+                  std::chrono::nanoseconds lower_bound,
+                  std::chrono::nanoseconds upper_bound);
+
+  // ToNanoseconds converts a bound to a duration, saturating bounds which are
+  // out of range such as those of catch-all buckets, since converting them
+  // directly is undefined.
+  static std::chrono::nanoseconds ToNanoseconds(double bound);
+
+  void Report(const std::string &name, const TagSet &tags, uint64_t samples,
+              StatsReporter *reporter) const;
 
   double lower_bound() const;
   double upper_bound() const;
@@ -48,7 +61,8 @@ class HistogramBucket {
   const uint64_t num_buckets_;
   const double lower_bound_;
   const double upper_bound_;
-  std::shared_ptr<CounterImpl> samples_;
+  const std::chrono::nanoseconds lower_duration_;
+  const std::chrono::nanoseconds upper_duration_;
 };
 
 }  // namespace tally
@@ -21,80 +21,255 @@
 #include "tally/src/histogram_impl.h"
 
 #include <limits>
+#include <new>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "tally/clock.h"
+#include "tally/src/cache_line.h"
+
 namespace tally {
 
-HistogramImpl::HistogramImpl(const Buckets &buckets) noexcept
-    : buckets_(CreateBuckets(buckets)) {}
+namespace {
 
-std::shared_ptr<HistogramImpl> HistogramImpl::New(
-    const Buckets &buckets) noexcept {
-  return std::shared_ptr<HistogramImpl>(new HistogramImpl(buckets));
-}
-
-std::vector<HistogramBucket> HistogramImpl::CreateBuckets(
-    const Buckets &buckets) {
-  std::vector<HistogramBucket> histogram_buckets;
-  auto const size = buckets.size();
-  auto const kind = buckets.kind();
-  if (size == 0) {
-    histogram_buckets.push_back(
-        HistogramBucket(kind, 0, 1, std::numeric_limits<double>::min(),
-                        std::numeric_limits<double>::max()));
-  } else {
-    histogram_buckets.reserve(size);
-
-    auto lower_bound = std::numeric_limits<double>::min();
-    for (auto it = buckets.begin(); it != buckets.end(); it++) {
-      auto upper_bound = *it;
-      auto index = static_cast<uint64_t>(std::distance(buckets.begin(), it));
-      histogram_buckets.push_back(HistogramBucket(kind, index, buckets.size(),
-                                                  lower_bound, upper_bound));
-      lower_bound = upper_bound;
+std::size_t CountsLines(std::size_t num_counts) {
+  auto const size = num_counts * sizeof(std::atomic<uint64_t>);
+  return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+}
+
+std::vector<double> UpperBounds(const Buckets &buckets) {
+  return std::vector<double>(buckets.begin(), buckets.end());
+}
+
+std::vector<int64_t> DurationBounds(const Buckets &buckets) {
+  std::vector<int64_t> bounds;
+  if (buckets.kind() == Buckets::Kind::Durations) {
+    bounds.reserve(buckets.size());
+    for (auto const bound : buckets) {
+      bounds.push_back(HistogramBucket::ToNanoseconds(bound).count());
     }
+  }
+  return bounds;
+}
+
+// BatchCounts holds the number of values in each bucket of a batch being
+// recorded by the current thread, along with the range of buckets touched so
+// that neither resetting nor flushing the counts scans every bucket. Counts are
+// left zeroed between batches.
+struct BatchCounts {
+  std::vector<uint64_t> counts;
+  std::size_t lowest;
+  std::size_t highest;
+};
 
-    // Add a catch-all bucket for anything past the last bucket.
-    histogram_buckets.push_back(
-        HistogramBucket(kind, buckets.size(), buckets.size(), lower_bound,
-                        std::numeric_limits<double>::max()));
+BatchCounts &ThreadBatchCounts(std::size_t num_counts) {
+  thread_local BatchCounts batch;
+  if (batch.counts.size() < num_counts) {
+    batch.counts.resize(num_counts, 0);
   }
+  batch.lowest = num_counts;
+  batch.highest = 0;
+  return batch;
+}
+
+}  // namespace
+
+HistogramImpl::HistogramImpl(const Buckets &buckets,
+                             std::shared_ptr<CellSlab> slab,
+                             uint32_t shards) noexcept
+    : kind_(buckets.kind()),
+      upper_bounds_(UpperBounds(buckets)),
+      duration_bounds_(DurationBounds(buckets)),
+      calculator_(buckets.calculator()),
+      closed_form_(calculator_.HasClosedFormIndex()),
+      integer_index_(calculator_.HasIntegerIndex()),
+      search_(closed_form_ ? nullptr : new BucketSearch(upper_bounds_)),
+      shard_mask_(RoundUpToPowerOfTwo(shards) - 1),
+      shard_stride_(CountsLines(upper_bounds_.size() + 1) * CACHE_LINE_SIZE /
+                    sizeof(std::atomic<uint64_t>)),
+      slab_(slab == nullptr
+                ? std::make_shared<CellSlab>(
+                      CountsLines(upper_bounds_.size() + 1) * (shard_mask_ + 1))
+                : std::move(slab)),
+      counts_(static_cast<std::atomic<uint64_t> *>(slab_->Allocate(
+          CountsLines(upper_bounds_.size() + 1) * (shard_mask_ + 1)))),
+      previous_(upper_bounds_.size() + 1, 0) {
+  for (std::size_t i = 0; i < shard_stride_ * (shard_mask_ + 1); i++) {
+    new (&counts_[i]) std::atomic<uint64_t>(0);
+  }
+}
 
-  return histogram_buckets;
+std::shared_ptr<HistogramImpl> HistogramImpl::New(
+    const Buckets &buckets) noexcept {
+  return New(buckets, nullptr);
+}
+
+std::shared_ptr<HistogramImpl> HistogramImpl::New(
+    const Buckets &buckets, std::shared_ptr<CellSlab> slab) noexcept {
+  return New(buckets, std::move(slab), 1);
+}
+
+std::shared_ptr<HistogramImpl> HistogramImpl::New(
+    const Buckets &buckets, std::shared_ptr<CellSlab> slab,
+    uint32_t shards) noexcept {
+  return std::shared_ptr<HistogramImpl>(
+      new HistogramImpl(buckets, std::move(slab), shards));
 }
 
 void HistogramImpl::Record(double val) noexcept {
-  // Find the first bucket who's upper bound is greater than val.
-  auto it = std::upper_bound(buckets_.begin(), buckets_.end(), val,
-                             [](double lhs, const HistogramBucket &rhs) {
-                               return lhs < rhs.upper_bound();
-                             });
-  it->Record();
+  Shard()[BucketIndex(val)].fetch_add(1, std::memory_order_relaxed);
 }
 
 void HistogramImpl::Record(std::chrono::nanoseconds val) noexcept {
-  Record(static_cast<double>(val.count()));
+  Shard()[BucketIndex(val)].fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Value>
+void HistogramImpl::RecordBatch(const Value *values, std::size_t num) noexcept {
+  auto &batch = ThreadBatchCounts(previous_.size());
+  for (std::size_t i = 0; i < num; i++) {
+    std::size_t const index = BucketIndex(values[i]);
+    batch.counts[index]++;
+    batch.lowest = std::min(batch.lowest, index);
+    batch.highest = std::max(batch.highest, index);
+  }
+
+  auto const shard = Shard();
+  for (auto i = batch.lowest; i <= batch.highest; i++) {
+    if (batch.counts[i] != 0) {
+      shard[i].fetch_add(batch.counts[i], std::memory_order_relaxed);
+      batch.counts[i] = 0;
+    }
+  }
+}
+
+void HistogramImpl::RecordMany(const double *values,
+                               std::size_t num) noexcept {
+  RecordBatch(values, num);
+}
+
+void HistogramImpl::RecordMany(const std::chrono::nanoseconds *values,
+                               std::size_t num) noexcept {
+  RecordBatch(values, num);
 }
 
 Stopwatch HistogramImpl::Start() noexcept {
-  return Stopwatch(std::chrono::steady_clock::now(), shared_from_this());
+  return Stopwatch(Clock::Now(), shared_from_this());
 }
 
 void HistogramImpl::RecordStopwatch(
     std::chrono::steady_clock::time_point start) {
-  auto const duration = std::chrono::steady_clock::now() - start;
+  auto const duration = Clock::Now() - start;
   Record(duration);
 }
 
-void HistogramImpl::Report(
-    const std::string &name,
-    const std::unordered_map<std::string, std::string> &tags,
-    StatsReporter *reporter) {
-  for (auto &bucket : buckets_) {
-    bucket.Report(name, tags, reporter);
+void HistogramImpl::Report(const std::string &name, const TagSet &tags,
+                           StatsReporter *reporter) {
+  for (std::size_t i = 0; i < previous_.size(); i++) {
+    uint64_t current = 0;
+    for (std::size_t shard = 0; shard <= shard_mask_; shard++) {
+      current += counts_[shard * shard_stride_ + i].load(
+          std::memory_order_relaxed);
+    }
+    auto const samples = current - previous_[i];
+    previous_[i] = current;
+    if (samples != 0) {
+      Bucket(i).Report(name, tags, samples, reporter);
+    }
+  }
+}
+
+std::atomic<uint64_t> *HistogramImpl::Shard() const noexcept {
+  // Avoid looking up the thread's index for unsharded histograms.
+  if (shard_mask_ == 0) {
+    return counts_;
+  }
+  return counts_ + (ThreadIndex() & shard_mask_) * shard_stride_;
+}
+
+uint64_t HistogramImpl::BucketIndex(
+    std::chrono::nanoseconds val) const noexcept {
+  if (integer_index_) {
+    return calculator_.IntegerIndex(val.count(), upper_bounds_.size());
+  }
+  if (kind_ != Buckets::Kind::Durations) {
+    return BucketIndex(static_cast<double>(val.count()));
+  }
+
+  // As for values, the closed form estimate is stepped towards the exact
+  // index, but by comparing against the bounds as integers.
+  if (closed_form_) {
+    auto const num_bounds = duration_bounds_.size();
+    auto index =
+        calculator_.Index(static_cast<double>(val.count()), num_bounds);
+    while (index > 0 && duration_bounds_[index - 1] > val.count()) {
+      index--;
+    }
+    while (index < num_bounds && duration_bounds_[index] <= val.count()) {
+      index++;
+    }
+    return index;
+  }
+
+  // Otherwise count the bounds less than or equal to the value with a binary
+  // search whose steps compile to conditional moves rather than branches,
+  // since which way each step goes is unpredictable.
+  auto const first = duration_bounds_.data();
+  auto base = first;
+  auto num = duration_bounds_.size();
+  if (num == 0) {
+    return 0;
+  }
+  while (num > 1) {
+    auto const half = num / 2;
+    base = base[half - 1] <= val.count() ? base + half : base;
+    num -= half;
+  }
+  return static_cast<uint64_t>(base - first) + (*base <= val.count() ? 1 : 0);
+}
+
+uint64_t HistogramImpl::BucketIndex(double val) const noexcept {
+  auto const num_bounds = upper_bounds_.size();
+
+  // The index of the first bucket whose upper bound is greater than val is the
+  // number of bounds which are less than or equal to it, so values past the
+  // last bound fall into the catch-all bucket.
+  if (!closed_form_) {
+    return search_->Find(val);
   }
+
+  // The closed form estimate may be off by one either way due to rounding, so
+  // step it towards the exact index by comparing against the actual bounds.
+  // NaN values compare false against every bound so are left in place.
+  auto index = calculator_.Index(val, num_bounds);
+  while (index > 0 && upper_bounds_[index - 1] > val) {
+    index--;
+  }
+  while (index < num_bounds && upper_bounds_[index] <= val) {
+    index++;
+  }
+  return index;
+}
+
+HistogramBucket HistogramImpl::Bucket(uint64_t index) const {
+  auto const num_bounds = upper_bounds_.size();
+  if (kind_ == Buckets::Kind::Durations) {
+    auto const lower_bound = index == 0 ? 0 : duration_bounds_[index - 1];
+    auto const upper_bound = index == num_bounds
+                                 ? std::numeric_limits<int64_t>::max()
+                                 : duration_bounds_[index];
+    return HistogramBucket(index, num_bounds,
+                           std::chrono::nanoseconds(lower_bound),
+                           std::chrono::nanoseconds(upper_bound));
+  }
+
+  auto const lower_bound = index == 0 ? std::numeric_limits<double>::min()
+                                      : upper_bounds_[index - 1];
+  auto const upper_bound = index == num_bounds
+                               ? std::numeric_limits<double>::max()
+                               : upper_bounds_[index];
+  return HistogramBucket(kind_, index, num_bounds, lower_bound, upper_bound);
 }
 
 }  // namespace tally
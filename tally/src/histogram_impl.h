@@ -21,16 +21,23 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "tally/buckets.h"
 #include "tally/counter.h"
 #include "tally/histogram.h"
-#include "tally/src/counter_impl.h"
+#include "tally/src/bucket_search.h"
+#include "tally/src/buckets_calculator.h"
+#include "tally/src/cell_slab.h"
 #include "tally/src/histogram_bucket.h"
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 class HistogramImpl : public Histogram,
@@ -42,6 +49,21 @@ class HistogramImpl : public Histogram,
   // inherits from the std::enable_shared_from_this class.
   static std::shared_ptr<HistogramImpl> New(const Buckets &buckets) noexcept;
 
+  // New returns a HistogramImpl whose bucket counts are allocated from `slab`.
+  // If `slab` is null the histogram allocates its counts from a slab of its
+  // own.
+  static std::shared_ptr<HistogramImpl> New(
+      const Buckets &buckets, std::shared_ptr<CellSlab> slab) noexcept;
+
+  // New returns a sharded HistogramImpl, whose bucket counts are replicated
+  // across `shards` cache-line-aligned arrays with each thread recording into
+  // one of them, so that threads recording into the same buckets concurrently
+  // do not contend. The shards are merged when the histogram is reported. The
+  // number of shards is rounded up to the nearest power of two.
+  static std::shared_ptr<HistogramImpl> New(const Buckets &buckets,
+                                            std::shared_ptr<CellSlab> slab,
+                                            uint32_t shards) noexcept;
+
   // Ensure the class is non-copyable.
   HistogramImpl(const HistogramImpl &) = delete;
 
@@ -52,22 +74,78 @@ class HistogramImpl : public Histogram,
 
   void Record(std::chrono::nanoseconds) noexcept;
 
+  void RecordMany(const double *values, std::size_t num) noexcept;
+
+  void RecordMany(const std::chrono::nanoseconds *values,
+                  std::size_t num) noexcept;
+
   Stopwatch Start() noexcept;
 
   // Methods to implement the StopwatchRecorder interface.
   void RecordStopwatch(std::chrono::steady_clock::time_point);
 
   // Report reports the current values of the Histogram's buckets.
-  void Report(const std::string &name,
-              const std::unordered_map<std::string, std::string> &tags,
+  void Report(const std::string &name, const TagSet &tags,
               StatsReporter *reporter);
 
  private:
-  explicit HistogramImpl(const Buckets &buckets) noexcept;
+  HistogramImpl(const Buckets &buckets, std::shared_ptr<CellSlab> slab,
+                uint32_t shards) noexcept;
+
+  // Shard returns the counts of the shard which the current thread records
+  // into.
+  std::atomic<uint64_t> *Shard() const noexcept;
+
+  // BucketIndex returns the index of the bucket which `val` falls into, i.e.
+  // the number of upper bounds which are less than or equal to it.
+  uint64_t BucketIndex(double val) const noexcept;
+
+  // BucketIndex returns the index of the bucket which `val` falls into. The
+  // bounds of Duration histograms are compared as integer nanoseconds, so
+  // durations are only converted to doubles to estimate closed form indices.
+  uint64_t BucketIndex(std::chrono::nanoseconds val) const noexcept;
+
+  // RecordBatch counts the bucket of each of the `num` values in thread-local
+  // storage before adding each bucket's count to the histogram with a single
+  // atomic operation.
+  template <typename Value>
+  void RecordBatch(const Value *values, std::size_t num) noexcept;
+
+  // Bucket returns a view of the bucket with the provided index.
+  HistogramBucket Bucket(uint64_t index) const;
+
+  const Buckets::Kind kind_;
+
+  // The upper bound of every bucket but the catch-all bucket, which holds any
+  // value greater than or equal to the last bound, in ascending order.
+  const std::vector<double> upper_bounds_;
+
+  // The upper bounds in nanoseconds for Duration histograms, which durations
+  // are recorded against exactly. Empty for Value histograms.
+  const std::vector<int64_t> duration_bounds_;
+
+  // The calculator which generated the upper bounds. When they follow a closed
+  // form it provides an estimate of a value's bucket in constant time, which
+  // saves a binary search over the bounds on every record.
+  const BucketsCalculator calculator_;
+  const bool closed_form_;
+  const bool integer_index_;
+
+  // Otherwise values are located among the bounds by a vectorized search,
+  // which is null for closed form bounds.
+  const std::unique_ptr<const BucketSearch> search_;
 
-  static std::vector<HistogramBucket> CreateBuckets(const Buckets &buckets);
+  // The number of samples recorded in each bucket, including the catch-all
+  // bucket, stored contiguously in cache-line-aligned storage from the slab.
+  // Each shard's counts begin `shard_stride_` counts after the previous
+  // shard's so that no two shards share a cache line.
+  const uint32_t shard_mask_;
+  const std::size_t shard_stride_;
+  std::shared_ptr<CellSlab> slab_;
+  std::atomic<uint64_t> *counts_;
 
-  std::vector<HistogramBucket> buckets_;
+  // The counts as of the last report, which are only accessed when reporting.
+  std::vector<uint64_t> previous_;
 };
 
 }  // namespace tally
@@ -0,0 +1,50 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/lap_stopwatch.h"
+
+#include "tally/clock.h"
+
+namespace tally {
+
+LapStopwatch::LapStopwatch() noexcept : last_(Clock::Now()) {}
+
+std::chrono::nanoseconds LapStopwatch::Lap(Timer &timer) {
+  auto const duration = Next();
+  timer.Record(duration);
+  return duration;
+}
+
+std::chrono::nanoseconds LapStopwatch::Lap(Histogram &histogram) {
+  auto const duration = Next();
+  histogram.Record(duration);
+  return duration;
+}
+
+void LapStopwatch::Skip() noexcept { last_ = Clock::Now(); }
+
+std::chrono::nanoseconds LapStopwatch::Next() noexcept {
+  auto const now = Clock::Now();
+  auto const duration = now - last_;
+  last_ = now;
+  return duration;
+}
+
+}  // namespace tally
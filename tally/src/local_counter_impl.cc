@@ -0,0 +1,46 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/local_counter_impl.h"
+
+#include <utility>
+
+namespace tally {
+
+LocalCounterImpl::LocalCounterImpl(
+    std::shared_ptr<CounterImpl> counter) noexcept
+    : cell_(0), counter_(std::move(counter)) {
+  counter_->Attach(&cell_);
+}
+
+LocalCounterImpl::~LocalCounterImpl() { counter_->Detach(&cell_); }
+
+void LocalCounterImpl::Inc() noexcept { Inc(1); }
+
+void LocalCounterImpl::Inc(int64_t delta) noexcept {
+  // The handle's thread is the only writer of the cell, so the increment does
+  // not need to be an atomic read-modify-write. Relaxed atomic loads and
+  // stores compile to plain moves but still allow the reporting thread to read
+  // the cell concurrently.
+  cell_.store(cell_.load(std::memory_order_relaxed) + delta,
+              std::memory_order_relaxed);
+}
+
+}  // namespace tally
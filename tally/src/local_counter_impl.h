@@ -0,0 +1,59 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "tally/counter.h"
+#include "tally/src/counter_impl.h"
+
+namespace tally {
+
+// LocalCounterImpl is a handle to a CounterImpl which buffers increments in a
+// cell owned by the handle. Increments are plain loads and stores rather than
+// atomic read-modify-write operations, so a handle must only ever be used from
+// a single thread. The cell is read by the CounterImpl whenever it is reported
+// and folded into it when the handle is destroyed, so no increments are lost
+// when the owning thread exits.
+class LocalCounterImpl : public Counter {
+ public:
+  explicit LocalCounterImpl(std::shared_ptr<CounterImpl> counter) noexcept;
+
+  ~LocalCounterImpl();
+
+  // Ensure the class is non-copyable.
+  LocalCounterImpl(const LocalCounterImpl &) = delete;
+
+  LocalCounterImpl &operator=(const LocalCounterImpl &) = delete;
+
+  // Methods to implement the Counter interface.
+  void Inc() noexcept;
+
+  void Inc(int64_t) noexcept;
+
+ private:
+  std::atomic<int64_t> cell_;
+  std::shared_ptr<CounterImpl> counter_;
+};
+
+}  // namespace tally
@@ -29,7 +29,8 @@ std::shared_ptr<StatsReporter> NoopStatsReporter::New() {
 }
 
 std::unique_ptr<tally::Capabilities> NoopStatsReporter::Capabilities() {
-  return std::unique_ptr<tally::Capabilities>(new CapableOf(false, false));
+  return std::unique_ptr<tally::Capabilities>(
+      new CapableOf(false, false, false));
 }
 
 void NoopStatsReporter::Flush() {}
@@ -60,4 +61,24 @@ void NoopStatsReporter::ReportHistogramDurationSamples(
     std::chrono::nanoseconds buckets_lower_bound,
     std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {}
 
+void NoopStatsReporter::ReportCounter(const std::string &name,
+                                      const TagSet &tags, int64_t value) {}
+
+void NoopStatsReporter::ReportGauge(const std::string &name,
+                                    const TagSet &tags, double value) {}
+
+void NoopStatsReporter::ReportTimer(const std::string &name,
+                                    const TagSet &tags,
+                                    std::chrono::nanoseconds value) {}
+
+void NoopStatsReporter::ReportHistogramValueSamples(
+    const std::string &name, const TagSet &tags, uint64_t bucket_id,
+    uint64_t num_buckets, double buckets_lower_bound,
+    double buckets_upper_bound, uint64_t samples) {}
+
+void NoopStatsReporter::ReportHistogramDurationSamples(
+    const std::string &name, const TagSet &tags, uint64_t bucket_id,
+    uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+    std::chrono::nanoseconds buckets_upper_bound, uint64_t samples) {}
+
 }  // namespace tally
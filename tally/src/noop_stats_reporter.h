@@ -24,6 +24,7 @@
 #include <unordered_map>
 
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
@@ -60,6 +61,25 @@ class NoopStatsReporter : public StatsReporter {
       uint64_t bucket_id, uint64_t num_buckets,
       std::chrono::nanoseconds buckets_lower_bound,
       std::chrono::nanoseconds buckets_upper_bound, uint64_t samples);
+
+  void ReportCounter(const std::string &name, const TagSet &tags,
+                     int64_t value);
+
+  void ReportGauge(const std::string &name, const TagSet &tags, double value);
+
+  void ReportTimer(const std::string &name, const TagSet &tags,
+                   std::chrono::nanoseconds value);
+
+  void ReportHistogramValueSamples(const std::string &name, const TagSet &tags,
+                                   uint64_t bucket_id, uint64_t num_buckets,
+                                   double buckets_lower_bound,
+                                   double buckets_upper_bound,
+                                   uint64_t samples);
+
+  void ReportHistogramDurationSamples(
+      const std::string &name, const TagSet &tags, uint64_t bucket_id,
+      uint64_t num_buckets, std::chrono::nanoseconds buckets_lower_bound,
+      std::chrono::nanoseconds buckets_upper_bound, uint64_t samples);
 };
 
 }  // namespace tally
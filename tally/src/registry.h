@@ -0,0 +1,262 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tally {
+
+// HashBytes returns a 64-bit hash of the `length` bytes at `bytes`, which mixes
+// in eight bytes at a time since metric names are often dozens of bytes long.
+inline uint64_t HashBytes(const char *bytes, std::size_t length) noexcept {
+  uint64_t hash = length * 0x9E3779B97F4A7C15ULL;
+  uint64_t word;
+  for (; length >= sizeof(word); length -= sizeof(word)) {
+    std::memcpy(&word, bytes, sizeof(word));
+    hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 32;
+    bytes += sizeof(word);
+  }
+  word = 0;
+  for (std::size_t i = 0; i < length; i++) {
+    word |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i]))
+            << (8 * i);
+  }
+  hash = (hash ^ word) * 0xC4CEB9FE1A85EC53ULL;
+  return hash ^ (hash >> 29);
+}
+
+// Registry is a map from names to metrics, or other values, which can be read
+// concurrently without locking. Since a Scope's metrics are never removed it
+// only supports insertion, which lets lookups proceed without any coordination
+// with writers: entries are published into an open-addressed table of atomic
+// pointers once they are fully constructed, and when the table grows the
+// previous tables are retained until the Registry is destroyed, so a reader
+// holding one never observes freed memory. Writers serialize on a mutex.
+//
+// Looking up an existing name therefore takes no lock and allocates nothing,
+// which matters because Scopes are commonly asked for the same metrics on
+// every request they serve.
+//
+// Each entry also holds the name its value is reported under, which is derived
+// from the name it is registered under once, when it is registered, rather than
+// every time it is reported.
+template <typename Value>
+class Registry {
+ public:
+  // Qualify returns the name an entry registered under `name` is reported
+  // under.
+  using Qualify = std::function<std::string(const std::string &name)>;
+
+  // Registry constructs a Registry whose entries are reported under the names
+  // they are registered under.
+  Registry()
+      : Registry([](const std::string &name) { return name; }) {}
+
+  // Registry constructs a Registry whose entries are reported under the names
+  // returned by `qualify`.
+  explicit Registry(Qualify qualify)
+      : table_(nullptr), size_(0), qualify_(std::move(qualify)) {
+    Grow(MIN_CAPACITY);
+  }
+
+  // Ensure the class is non-copyable.
+  Registry(const Registry &) = delete;
+
+  Registry &operator=(const Registry &) = delete;
+
+  // Find returns the value registered under the `length` bytes at `name`, or
+  // null if there is none.
+  std::shared_ptr<Value> Find(const char *name,
+                              std::size_t length) const noexcept {
+    return Find(HashBytes(name, length), NameMatches(name, length));
+  }
+
+  std::shared_ptr<Value> Find(const std::string &name) const noexcept {
+    return Find(name.data(), name.length());
+  }
+
+  // Find returns the value of the entry registered with `hash` for which
+  // `matches(name, value)` is true, or null if there is none. This lets values
+  // be looked up by keys other than their names, so long as the keys hash the
+  // same way when they match.
+  template <typename Matches>
+  std::shared_ptr<Value> Find(uint64_t hash, Matches matches) const {
+    auto const node =
+        Lookup(*table_.load(std::memory_order_acquire), hash, matches);
+    return node == nullptr ? nullptr : node->value;
+  }
+
+  // FindOrCreate returns the value registered under `name`, registering the
+  // value returned by `create` under it first if there is none. Since values
+  // are only created once no other is registered under the name, creating one
+  // need not be undone. If `create` throws nothing is registered.
+  template <typename Create>
+  std::shared_ptr<Value> FindOrCreate(const std::string &name, Create create) {
+    return FindOrCreate(HashBytes(name.data(), name.length()),
+                        NameMatches(name.data(), name.length()), name, create);
+  }
+
+  // FindOrCreate returns the value of the entry registered with `hash` for
+  // which `matches(name, value)` is true, registering the value returned by
+  // `create` under `name` and `hash` first if there is none.
+  template <typename Matches, typename Create>
+  std::shared_ptr<Value> FindOrCreate(uint64_t hash, Matches matches,
+                                      const std::string &name, Create create) {
+    auto value = Find(hash, matches);
+    if (value != nullptr) {
+      return value;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Check again now that no other writer can register the entry.
+    auto table = table_.load(std::memory_order_relaxed);
+    auto const existing = Lookup(*table, hash, matches);
+    if (existing != nullptr) {
+      return existing->value;
+    }
+
+    std::unique_ptr<Node> node(new Node{name, hash, create(), qualify_(name)});
+    if ((size_ + 1) * 2 > table->mask + 1) {
+      table = Grow((table->mask + 1) * 2);
+    }
+    Publish(*table, node.get());
+    nodes_.push_back(std::move(node));
+    size_++;
+    return nodes_.back()->value;
+  }
+
+  // ForEach calls `function` with the name each registered entry is reported
+  // under and its value. The name remains valid for the lifetime of the
+  // Registry. Entries registered concurrently may or may not be visited.
+  template <typename Function>
+  void ForEach(Function function) const {
+    auto const table = table_.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i <= table->mask; i++) {
+      auto const node = table->slots[i].load(std::memory_order_acquire);
+      if (node != nullptr) {
+        function(node->qualified_name, node->value);
+      }
+    }
+  }
+
+ private:
+  // The number of slots of a Registry's initial table, which must be a power
+  // of two.
+  static constexpr std::size_t MIN_CAPACITY = 16;
+
+  struct Node {
+    const std::string name;
+    const uint64_t hash;
+    const std::shared_ptr<Value> value;
+    const std::string qualified_name;
+  };
+
+  struct Table {
+    explicit Table(std::size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<Node *>[capacity]) {
+      for (std::size_t i = 0; i < capacity; i++) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    const std::size_t mask;
+    const std::unique_ptr<std::atomic<Node *>[]> slots;
+  };
+
+  // NameMatches matches the entry registered under the `length` bytes at
+  // `name`.
+  struct NameMatches {
+    NameMatches(const char *name, std::size_t length) noexcept
+        : name(name), length(length) {}
+
+    bool operator()(const std::string &other, const Value &) const noexcept {
+      return other.length() == length &&
+             other.compare(0, length, name, length) == 0;
+    }
+
+    const char *const name;
+    const std::size_t length;
+  };
+
+  // Lookup returns the node in `table` registered with `hash` which `matches`
+  // by probing linearly from the slot `hash` maps to, or null if it reaches an
+  // empty slot first.
+  template <typename Matches>
+  static Node *Lookup(const Table &table, uint64_t hash, Matches &matches) {
+    for (auto i = hash & table.mask;; i = (i + 1) & table.mask) {
+      auto const node = table.slots[i].load(std::memory_order_acquire);
+      if (node == nullptr) {
+        return nullptr;
+      }
+      if (node->hash == hash && matches(node->name, *node->value)) {
+        return node;
+      }
+    }
+  }
+
+  // Publish places `node` in the first empty slot of its probe sequence in
+  // `table`, making it visible to readers.
+  static void Publish(Table &table, Node *node) noexcept {
+    auto i = node->hash & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & table.mask;
+    }
+    table.slots[i].store(node, std::memory_order_release);
+  }
+
+  // Grow replaces the current table with one with `capacity` slots holding the
+  // same nodes, and returns it. The caller must hold the mutex.
+  Table *Grow(std::size_t capacity) {
+    std::unique_ptr<Table> table(new Table(capacity));
+    for (auto const &node : nodes_) {
+      Publish(*table, node.get());
+    }
+    tables_.push_back(std::move(table));
+    table_.store(tables_.back().get(), std::memory_order_release);
+    return tables_.back().get();
+  }
+
+  std::atomic<Table *> table_;
+
+  // The state below is only accessed by writers, which hold the mutex. Every
+  // table and node is owned here so that none is freed before the Registry.
+  std::mutex mutex_;
+  std::size_t size_;
+  const Qualify qualify_;
+  std::vector<std::unique_ptr<Table>> tables_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+};
+
+template <typename Value>
+constexpr std::size_t Registry<Value>::MIN_CAPACITY;
+
+}  // namespace tally
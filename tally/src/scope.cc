@@ -0,0 +1,90 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/scope.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace tally {
+
+namespace {
+
+// The finest split of each power of two which the Histogram returned in place
+// of a sketch uses, which bounds it to a few thousand buckets.
+const uint32_t MAX_SKETCH_SIGNIFICANT_BITS = 7;
+
+// The largest value and duration which the Histogram returned in place of a
+// sketch has buckets for.
+const uint64_t MAX_SKETCH_VALUE = uint64_t(1) << 32;
+const std::chrono::nanoseconds MAX_SKETCH_DURATION(int64_t(1) << 36);
+
+// ForwardingCounter is the handle which LocalCounter returns for Scopes which
+// do not buffer increments locally. It increments the shared Counter directly.
+class ForwardingCounter : public tally::Counter {
+ public:
+  explicit ForwardingCounter(std::shared_ptr<tally::Counter> counter) noexcept
+      : counter_(std::move(counter)) {}
+
+  // Ensure the class is non-copyable.
+  ForwardingCounter(const ForwardingCounter &) = delete;
+
+  ForwardingCounter &operator=(const ForwardingCounter &) = delete;
+
+  // Methods to implement the Counter interface.
+  void Inc() noexcept { counter_->Inc(); }
+
+  void Inc(int64_t value) noexcept { counter_->Inc(value); }
+
+ private:
+  const std::shared_ptr<tally::Counter> counter_;
+};
+
+}  // namespace
+
+std::unique_ptr<tally::Counter> Scope::LocalCounter(
+    const std::string &name) noexcept {
+  return std::unique_ptr<tally::Counter>(new ForwardingCounter(Counter(name)));
+}
+
+std::shared_ptr<tally::Histogram> Scope::Sketch(const std::string &name,
+                                                Buckets::Kind kind,
+                                                double relative_accuracy) {
+  if (!(relative_accuracy > 0 && relative_accuracy < 1)) {
+    throw std::invalid_argument("Relative accuracy must lie in (0, 1)");
+  }
+
+  auto const bits = std::min(
+      MAX_SKETCH_SIGNIFICANT_BITS,
+      static_cast<uint32_t>(
+          std::max(1.0, std::ceil(-std::log2(relative_accuracy)))));
+  if (kind == Buckets::Kind::Durations) {
+    return Histogram(name,
+                     Buckets::LogLinearDurations(bits, MAX_SKETCH_DURATION));
+  }
+  return Histogram(name, Buckets::LogLinearValues(bits, MAX_SKETCH_VALUE));
+}
+
+}  // namespace tally
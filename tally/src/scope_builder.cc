@@ -21,6 +21,7 @@
 #include "tally/scope_builder.h"
 
 #include "tally/src/scope_impl.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
@@ -28,6 +29,10 @@ namespace {
 const std::string DEFAULT_PREFIX = "";
 const std::string DEFAULT_SEPARATOR = ".";
 const std::chrono::seconds DEFAULT_REPORTING_INTERVAL = std::chrono::seconds(0);
+const uint32_t DEFAULT_COUNTER_STRIPES = 1;
+const uint32_t DEFAULT_HISTOGRAM_SHARDS = 1;
+const Timer::Mode DEFAULT_TIMER_MODE = Timer::Mode::Immediate;
+const uint32_t DEFAULT_TIMER_RESERVOIR_SIZE = 128;
 const std::unordered_map<std::string, std::string> DEFAULT_TAGS =
     std::unordered_map<std::string, std::string>{};
 const std::shared_ptr<StatsReporter> DEFAULT_REPORTER =
@@ -38,6 +43,10 @@ ScopeBuilder::ScopeBuilder()
     : prefix_(DEFAULT_PREFIX),
       separator_(DEFAULT_SEPARATOR),
       reporting_interval_(DEFAULT_REPORTING_INTERVAL),
+      counter_stripes_(DEFAULT_COUNTER_STRIPES),
+      histogram_shards_(DEFAULT_HISTOGRAM_SHARDS),
+      timer_mode_(DEFAULT_TIMER_MODE),
+      timer_reservoir_size_(DEFAULT_TIMER_RESERVOIR_SIZE),
       tags_(DEFAULT_TAGS),
       reporter_(DEFAULT_REPORTER) {}
 
@@ -69,10 +78,32 @@ ScopeBuilder &ScopeBuilder::reporting_interval(
   return *this;
 }
 
+ScopeBuilder &ScopeBuilder::counter_stripes(uint32_t stripes) noexcept {
+  counter_stripes_ = stripes;
+  return *this;
+}
+
+ScopeBuilder &ScopeBuilder::histogram_shards(uint32_t shards) noexcept {
+  histogram_shards_ = shards;
+  return *this;
+}
+
+ScopeBuilder &ScopeBuilder::timer_mode(Timer::Mode mode) noexcept {
+  timer_mode_ = mode;
+  return *this;
+}
+
+ScopeBuilder &ScopeBuilder::timer_reservoir_size(uint32_t size) noexcept {
+  timer_reservoir_size_ = size;
+  return *this;
+}
+
 std::unique_ptr<Scope> ScopeBuilder::Build() noexcept {
-  return std::unique_ptr<Scope>{
-      new ScopeImpl(this->prefix_, this->separator_, this->tags_,
-                    this->reporting_interval_, this->reporter_)};
+  return std::unique_ptr<Scope>{new ScopeImpl(
+      this->prefix_, this->separator_, TagSet::Intern(this->tags_),
+      this->reporting_interval_, this->reporter_, this->counter_stripes_,
+      this->histogram_shards_, this->timer_mode_, this->timer_reservoir_size_,
+      CellSlab::New())};
 }
 
 }  // namespace tally
@@ -20,31 +20,54 @@
 
 #include "tally/src/scope_impl.h"
 
-#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <mutex>
-#include <sstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <utility>
-#include <vector>
 
-#include "tally/scope_builder.h"
 #include "tally/src/capable_of.h"
+#include "tally/src/local_counter_impl.h"
 #include "tally/src/noop_stats_reporter.h"
 
 namespace tally {
 
+namespace {
+
+// DefaultTimerBuckets returns the buckets which Buffered timers record the
+// distribution of their durations into, which double from 10 microseconds to
+// roughly 84 seconds.
+Buckets DefaultTimerBuckets() {
+  return Buckets::ExponentialDurations(std::chrono::microseconds(10), 2, 24);
+}
+
+}  // namespace
+
 ScopeImpl::ScopeImpl(const std::string &prefix, const std::string &separator,
-                     const std::unordered_map<std::string, std::string> &tags,
+                     std::shared_ptr<const TagSet> tags,
                      std::chrono::seconds interval,
-                     std::shared_ptr<StatsReporter> reporter) noexcept
+                     std::shared_ptr<StatsReporter> reporter,
+                     uint32_t counter_stripes, uint32_t histogram_shards,
+                     tally::Timer::Mode timer_mode,
+                     uint32_t timer_reservoir_size,
+                     std::shared_ptr<CellSlab> slab) noexcept
     : prefix_(prefix),
       separator_(separator),
-      tags_(tags),
+      tags_(std::move(tags)),
       interval_(interval),
       reporter_((reporter == nullptr) ? NoopStatsReporter::New() : reporter),
-      running_(false) {
+      counter_stripes_(counter_stripes),
+      histogram_shards_(histogram_shards),
+      timer_mode_(timer_mode),
+      timer_reservoir_size_(timer_reservoir_size),
+      slab_((slab == nullptr) ? CellSlab::New() : slab),
+      running_(false),
+      counters_(Qualifier()),
+      gauges_(Qualifier()),
+      callback_gauges_(Qualifier()),
+      histograms_(Qualifier()) {
   if (interval > std::chrono::seconds(0)) {
     running_ = true;
     thread_ = std::thread(&ScopeImpl::Run, this);
@@ -71,136 +94,236 @@ ScopeImpl::~ScopeImpl() {
 
 std::shared_ptr<tally::Counter> ScopeImpl::Counter(
     const std::string &name) noexcept {
-  std::lock_guard<std::mutex> lock(this->counters_mutex_);
+  return FindOrCreateCounter(name);
+}
+
+std::shared_ptr<tally::Counter> ScopeImpl::Counter(const char *name) noexcept {
+  auto counter = counters_.Find(name, std::strlen(name));
+  if (counter != nullptr) {
+    return counter;
+  }
+  return FindOrCreateCounter(name);
+}
+
+std::unique_ptr<tally::Counter> ScopeImpl::LocalCounter(
+    const std::string &name) noexcept {
+  return std::unique_ptr<tally::Counter>(
+      new LocalCounterImpl(FindOrCreateCounter(name)));
+}
 
-  auto entry = this->counters_.insert(
-      std::pair<std::string, std::shared_ptr<CounterImpl>>(
-          name, std::shared_ptr<CounterImpl>(new CounterImpl())));
-  return entry.first->second;
+std::shared_ptr<CounterImpl> ScopeImpl::FindOrCreateCounter(
+    const std::string &name) {
+  // Metrics allocate storage from the slab when they are constructed which is
+  // never reclaimed, so a metric must only be constructed once it is known
+  // that no metric with the same name exists.
+  return counters_.FindOrCreate(name, [this]() {
+    return std::make_shared<CounterImpl>(counter_stripes_, slab_);
+  });
 }
 
 std::shared_ptr<tally::Gauge> ScopeImpl::Gauge(
     const std::string &name) noexcept {
-  std::lock_guard<std::mutex> lock(this->gauges_mutex_);
+  return Gauge(name, tally::Gauge::Aggregation::Last);
+}
+
+std::shared_ptr<tally::Gauge> ScopeImpl::Gauge(const char *name) noexcept {
+  return Gauge(name, tally::Gauge::Aggregation::Last);
+}
+
+std::shared_ptr<tally::Gauge> ScopeImpl::Gauge(
+    const char *name, tally::Gauge::Aggregation aggregation) noexcept {
+  auto gauge = gauges_.Find(name, std::strlen(name));
+  if (gauge != nullptr) {
+    return gauge;
+  }
+  return Gauge(std::string(name), aggregation);
+}
 
-  auto entry =
-      this->gauges_.insert(std::pair<std::string, std::shared_ptr<GaugeImpl>>(
-          name, std::shared_ptr<GaugeImpl>(new GaugeImpl())));
-  return entry.first->second;
+std::shared_ptr<tally::Gauge> ScopeImpl::Gauge(
+    const std::string &name, tally::Gauge::Aggregation aggregation) noexcept {
+  return gauges_.FindOrCreate(name, [this, aggregation]() {
+    return std::make_shared<GaugeImpl>(aggregation, slab_);
+  });
+}
+
+void ScopeImpl::CallbackGauge(const std::string &name,
+                              std::function<double()> callback) noexcept {
+  // The first callback registered under a name is kept.
+  callback_gauges_.FindOrCreate(name, [&callback]() {
+    return std::make_shared<CallbackGaugeImpl>(std::move(callback));
+  });
 }
 
 std::shared_ptr<tally::Timer> ScopeImpl::Timer(
     const std::string &name) noexcept {
-  std::lock_guard<std::mutex> lock(this->timers_mutex_);
-
-  // Since the timer reports metrics itself it must be initialized with the
-  // fully qualified name.
-  auto entry =
-      this->timers_.insert(std::pair<std::string, std::shared_ptr<TimerImpl>>(
-          name, TimerImpl::New(FullyQualifiedName(name), tags_, reporter_)));
-  return entry.first->second;
+  return timers_.FindOrCreate(name, [this, &name]() { return NewTimer(name); });
+}
+
+std::shared_ptr<tally::Timer> ScopeImpl::Timer(const char *name) noexcept {
+  auto timer = timers_.Find(name, std::strlen(name));
+  if (timer != nullptr) {
+    return timer;
+  }
+  return Timer(std::string(name));
+}
+
+std::shared_ptr<TimerImpl> ScopeImpl::NewTimer(const std::string &name) {
+  // Timers are aggregated rather than reporting every duration if the reporter
+  // prefers it, unless a mode other than the default was chosen explicitly.
+  auto mode = timer_mode_;
+  if (mode == tally::Timer::Mode::Immediate) {
+    auto const capabilities = reporter_->Capabilities();
+    if (capabilities != nullptr && capabilities->AggregatedTimers()) {
+      mode = tally::Timer::Mode::Buffered;
+    }
+  }
+
+  // Timers are initialized with the fully qualified name, which an Immediate
+  // timer reports each duration under and which Buffered and Sampled timers
+  // derive the names of their aggregates from when they are constructed.
+  auto const qualified_name = FullyQualifiedName(name);
+  std::shared_ptr<TimerImpl> timer;
+  switch (mode) {
+    case tally::Timer::Mode::Buffered:
+      timer = TimerImpl::New(qualified_name, DefaultTimerBuckets(), separator_,
+                             counter_stripes_, histogram_shards_, slab_);
+      break;
+    case tally::Timer::Mode::Sampled:
+      timer = TimerImpl::New(qualified_name, timer_reservoir_size_, separator_,
+                             counter_stripes_, slab_);
+      break;
+    case tally::Timer::Mode::Immediate:
+      timer = TimerImpl::New(qualified_name, tags_, reporter_);
+      break;
+  }
+  return timer;
 }
 
 std::shared_ptr<tally::Histogram> ScopeImpl::Histogram(
     const std::string &name, const Buckets &buckets) noexcept {
-  std::lock_guard<std::mutex> lock(this->histograms_mutex_);
+  return histograms_.FindOrCreate(name, [this, &buckets]() {
+    return HistogramImpl::New(buckets, slab_, histogram_shards_);
+  });
+}
 
-  auto entry = this->histograms_.insert(
-      std::pair<std::string, std::shared_ptr<HistogramImpl>>(
-          name, HistogramImpl::New(buckets)));
-  return entry.first->second;
+std::shared_ptr<tally::Histogram> ScopeImpl::Histogram(
+    const char *name, const Buckets &buckets) noexcept {
+  auto histogram = histograms_.Find(name, std::strlen(name));
+  if (histogram != nullptr) {
+    return histogram;
+  }
+  return Histogram(std::string(name), buckets);
+}
+
+std::shared_ptr<tally::Histogram> ScopeImpl::Sketch(const std::string &name,
+                                                    Buckets::Kind kind,
+                                                    double relative_accuracy) {
+  return sketches_.FindOrCreate(name, [this, &name, kind, relative_accuracy]() {
+    return SketchImpl::New(FullyQualifiedName(name), kind, relative_accuracy,
+                           separator_);
+  });
 }
 
 std::shared_ptr<tally::Scope> ScopeImpl::SubScope(
     const std::string &name) noexcept {
-  return SubScope(FullyQualifiedName(name),
-                  std::unordered_map<std::string, std::string>{});
+  auto const scope = subscopes_.Find(name);
+  if (scope != nullptr) {
+    return scope;
+  }
+
+  return subscopes_.FindOrCreate(name, [this, &name]() {
+    return Child(FullyQualifiedName(name),
+                 std::unordered_map<std::string, std::string>{});
+  });
 }
 
 std::shared_ptr<tally::Scope> ScopeImpl::Tagged(
     const std::unordered_map<std::string, std::string> &tags) noexcept {
-  return SubScope(prefix_, tags);
+  auto const hash = TagsHash(tags);
+  auto const matches = [&tags](const std::string &,
+                               const TaggedScope &entry) {
+    return entry.tags == tags;
+  };
+
+  auto entry = tagged_.Find(hash, matches);
+  if (entry == nullptr) {
+    entry = tagged_.FindOrCreate(hash, matches, "", [this, &tags]() {
+      return std::make_shared<TaggedScope>(
+          TaggedScope{tags, Child(prefix_, tags)});
+    });
+  }
+  return entry->scope;
 }
 
 std::unique_ptr<tally::Capabilities> ScopeImpl::Capabilities() noexcept {
   if (reporter_ == nullptr) {
-    return std::unique_ptr<tally::Capabilities>(new CapableOf(false, false));
+    return std::unique_ptr<tally::Capabilities>(
+        new CapableOf(false, false, false));
   }
   return reporter_->Capabilities();
 }
 
-std::shared_ptr<tally::Scope> ScopeImpl::SubScope(
+std::shared_ptr<ScopeImpl> ScopeImpl::Child(
     const std::string &prefix,
     const std::unordered_map<std::string, std::string> &tags) {
-  std::unordered_map<std::string, std::string> new_tags;
-
-  // Insert the new tags second as they take priority over the scope's tags.
-  for (auto const &tag : tags_) {
-    new_tags.insert(tag);
-  }
-
-  for (auto const &tag : tags) {
-    new_tags.insert(tag);
-  }
-
-  auto id = ScopeID(prefix, new_tags);
-
-  std::shared_ptr<Scope> scope = ScopeBuilder()
-                                     .reporter(reporter_)
-                                     .prefix(prefix)
-                                     .separator(separator_)
-                                     .tags(new_tags)
-                                     .Build();
-
-  std::lock_guard<std::mutex> lock(this->registry_mutex_);
-  auto entry =
-      this->registry_.insert(std::pair<std::string, std::shared_ptr<ScopeImpl>>(
-          id, std::shared_ptr<ScopeImpl>(
-                  std::dynamic_pointer_cast<ScopeImpl>(scope))));
-  return entry.first->second;
+  auto new_tags = tags_->Merge(tags);
+
+  // Subscopes are reported by their parent so they are constructed without a
+  // reporting interval of their own.
+  return registry_.FindOrCreate(
+      ScopeID(prefix, *new_tags), [this, &prefix, &new_tags]() {
+        return std::make_shared<ScopeImpl>(
+            prefix, separator_, new_tags, std::chrono::seconds(0), reporter_,
+            counter_stripes_, histogram_shards_, timer_mode_,
+            timer_reservoir_size_, slab_);
+      });
 }
 
-std::string ScopeImpl::FullyQualifiedName(const std::string &name) {
-  if (prefix_ == "") {
+std::string ScopeImpl::FullyQualifiedName(const std::string &name) const {
+  if (prefix_.empty()) {
     return name;
   }
 
   std::string str;
   str.reserve(prefix_.length() + separator_.length() + name.length());
-  std::ostringstream stream(str);
-  stream << prefix_ << separator_ << name;
+  str.append(prefix_).append(separator_).append(name);
+  return str;
+}
 
-  return stream.str();
+std::function<std::string(const std::string &)> ScopeImpl::Qualifier() const {
+  return [this](const std::string &name) { return FullyQualifiedName(name); };
 }
 
-std::string ScopeImpl::ScopeID(
-    const std::string &prefix,
-    const std::unordered_map<std::string, std::string> &tags) {
-  std::vector<std::string> keys;
-  keys.reserve(tags.size());
-  std::transform(
-      std::begin(tags), std::end(tags), std::back_inserter(keys),
-      [](const std::pair<std::string, std::string> &tag) { return tag.first; });
+uint64_t ScopeImpl::TagsHash(
+    const std::unordered_map<std::string, std::string> &tags) noexcept {
+  // Sum the hashes of the tags so that they can be combined in any order.
+  uint64_t hash = tags.size();
+  for (auto const &tag : tags) {
+    auto const key = HashBytes(tag.first.data(), tag.first.length());
+    auto const value = HashBytes(tag.second.data(), tag.second.length());
+    hash += (key * 0x9E3779B97F4A7C15ULL) ^ value;
+  }
+  return hash;
+}
 
-  std::sort(keys.begin(), keys.end());
+std::string ScopeImpl::ScopeID(const std::string &prefix,
+                               const TagSet &tags) {
+  std::size_t length = prefix.length() + 1;
+  for (auto const &tag : tags) {
+    length += tag.first.length() + tag.second.length() + 2;
+  }
 
   std::string str;
-  str.reserve(prefix.length() + keys.size() * 20);
-  std::ostringstream stream(str);
-
-  stream << prefix;
-  stream << "+";
-
-  for (auto it = keys.begin(); it < keys.end(); it++) {
-    auto key = *it;
-    stream << key << "=" << tags.at(key);
-
-    if (it != keys.end() - 1) {
-      stream << ",";
+  str.reserve(length);
+  str.append(prefix).append("+");
+  for (auto it = tags.begin(); it != tags.end(); it++) {
+    if (it != tags.begin()) {
+      str.append(",");
     }
+    str.append(it->first).append("=").append(it->second);
   }
 
-  return stream.str();
+  return str;
 }
 
 void ScopeImpl::Run() {
@@ -220,39 +343,41 @@ void ScopeImpl::Run() {
 }
 
 void ScopeImpl::Report() {
-  {
-    std::lock_guard<std::mutex> lock(this->counters_mutex_);
-    for (auto const &entry : counters_) {
-      auto name = entry.first;
-      auto counter = entry.second;
-      counter->Report(FullyQualifiedName(name), tags_, reporter_.get());
-    }
-  }
-
-  {
-    std::lock_guard<std::mutex> lock(this->gauges_mutex_);
-    for (auto const &entry : gauges_) {
-      auto name = entry.first;
-      auto gauge = entry.second;
-      gauge->Report(FullyQualifiedName(name), tags_, reporter_.get());
-    }
-  }
-
-  {
-    std::lock_guard<std::mutex> lock(this->histograms_mutex_);
-    for (auto const &entry : histograms_) {
-      auto name = entry.first;
-      auto histogram = entry.second;
-      histogram->Report(FullyQualifiedName(name), tags_, reporter_.get());
-    }
-  }
-
-  {
-    std::lock_guard<std::mutex> lock(this->registry_mutex_);
-    for (auto const &entry : registry_) {
-      entry.second->Report();
-    }
-  }
+  counters_.ForEach([this](const std::string &name,
+                           const std::shared_ptr<CounterImpl> &counter) {
+    counter->Report(name, *tags_, reporter_.get());
+  });
+
+  gauges_.ForEach([this](const std::string &name,
+                         const std::shared_ptr<GaugeImpl> &gauge) {
+    gauge->Report(name, *tags_, reporter_.get());
+  });
+
+  callback_gauges_.ForEach(
+      [this](const std::string &name,
+             const std::shared_ptr<CallbackGaugeImpl> &gauge) {
+        gauge->Report(name, *tags_, reporter_.get());
+      });
+
+  timers_.ForEach([this](const std::string &,
+                         const std::shared_ptr<TimerImpl> &timer) {
+    timer->Report(*tags_, reporter_.get());
+  });
+
+  histograms_.ForEach([this](const std::string &name,
+                             const std::shared_ptr<HistogramImpl> &histogram) {
+    histogram->Report(name, *tags_, reporter_.get());
+  });
+
+  sketches_.ForEach([this](const std::string &,
+                           const std::shared_ptr<SketchImpl> &sketch) {
+    sketch->Report(*tags_, reporter_.get());
+  });
+
+  registry_.ForEach([](const std::string &,
+                       const std::shared_ptr<ScopeImpl> &scope) {
+    scope->Report();
+  });
 }
 
 }  // namespace tally
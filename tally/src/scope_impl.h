@@ -21,26 +21,34 @@
 #pragma once
 
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
 
 #include "tally/scope.h"
+#include "tally/src/callback_gauge_impl.h"
+#include "tally/src/cell_slab.h"
 #include "tally/src/counter_impl.h"
 #include "tally/src/gauge_impl.h"
 #include "tally/src/histogram_impl.h"
+#include "tally/src/registry.h"
+#include "tally/src/sketch_impl.h"
 #include "tally/src/timer_impl.h"
 #include "tally/stats_reporter.h"
+#include "tally/tag_set.h"
 
 namespace tally {
 
 class ScopeImpl : public Scope {
  public:
   ScopeImpl(const std::string &prefix, const std::string &separator,
-            const std::unordered_map<std::string, std::string> &tags,
-            std::chrono::seconds interval,
-            std::shared_ptr<StatsReporter> reporter) noexcept;
+            std::shared_ptr<const TagSet> tags, std::chrono::seconds interval,
+            std::shared_ptr<StatsReporter> reporter,
+            uint32_t counter_stripes, uint32_t histogram_shards,
+            tally::Timer::Mode timer_mode, uint32_t timer_reservoir_size,
+            std::shared_ptr<CellSlab> slab) noexcept;
 
   ~ScopeImpl();
 
@@ -52,13 +60,39 @@ class ScopeImpl : public Scope {
   // Methods to implement the Scope interface.
   std::shared_ptr<tally::Counter> Counter(const std::string &name) noexcept;
 
+  std::shared_ptr<tally::Counter> Counter(const char *name) noexcept;
+
+  std::unique_ptr<tally::Counter> LocalCounter(
+      const std::string &name) noexcept;
+
   std::shared_ptr<tally::Gauge> Gauge(const std::string &name) noexcept;
 
+  std::shared_ptr<tally::Gauge> Gauge(const char *name) noexcept;
+
+  std::shared_ptr<tally::Gauge> Gauge(
+      const std::string &name,
+      tally::Gauge::Aggregation aggregation) noexcept;
+
+  std::shared_ptr<tally::Gauge> Gauge(
+      const char *name, tally::Gauge::Aggregation aggregation) noexcept;
+
+  void CallbackGauge(const std::string &name,
+                     std::function<double()> callback) noexcept;
+
   std::shared_ptr<tally::Timer> Timer(const std::string &name) noexcept;
 
+  std::shared_ptr<tally::Timer> Timer(const char *name) noexcept;
+
   std::shared_ptr<tally::Histogram> Histogram(const std::string &name,
                                               const Buckets &buckets) noexcept;
 
+  std::shared_ptr<tally::Histogram> Histogram(const char *name,
+                                              const Buckets &buckets) noexcept;
+
+  std::shared_ptr<tally::Histogram> Sketch(const std::string &name,
+                                           Buckets::Kind kind,
+                                           double relative_accuracy);
+
   std::shared_ptr<tally::Scope> SubScope(const std::string &name) noexcept;
 
   std::shared_ptr<tally::Scope> Tagged(
@@ -67,50 +101,90 @@ class ScopeImpl : public Scope {
   std::unique_ptr<tally::Capabilities> Capabilities() noexcept;
 
  private:
-  // SubScope constructs a subscope with the provided prefix and tags.
-  std::shared_ptr<tally::Scope> SubScope(
+  // ScopeImplPeer lets benchmarks report a Scope on demand rather than only
+  // from its reporting thread.
+  friend class ScopeImplPeer;
+
+  // Report reports the Scope's metrics, and those of its subscopes, to its
+  // Reporter.
+  void Report();
+
+  // FindOrCreateCounter returns the counter with the provided name, creating it
+  // if it does not exist yet.
+  std::shared_ptr<CounterImpl> FindOrCreateCounter(const std::string &name);
+
+  // NewTimer constructs a timer with the provided name in the Scope's timer
+  // mode.
+  std::shared_ptr<TimerImpl> NewTimer(const std::string &name);
+
+  // A subscope returned by Tagged, along with the tags it was requested with.
+  struct TaggedScope {
+    const std::unordered_map<std::string, std::string> tags;
+    const std::shared_ptr<ScopeImpl> scope;
+  };
+
+  // Child returns the subscope with the provided prefix and the Scope's tags
+  // overridden by the provided tags, constructing it if it does not exist yet.
+  std::shared_ptr<ScopeImpl> Child(
       const std::string &prefix,
       const std::unordered_map<std::string, std::string> &tags);
 
   // FullyQualifiedName returns the fully qualified name of the provided name.
-  std::string FullyQualifiedName(const std::string &name);
+  std::string FullyQualifiedName(const std::string &name) const;
+
+  // Qualifier returns a function which returns the fully qualified name of the
+  // provided name, which the Scope's metrics are registered with so that it is
+  // computed once rather than every time they are reported.
+  std::function<std::string(const std::string &)> Qualifier() const;
+
+  // TagsHash returns a hash of the provided tags which does not depend on the
+  // order they are iterated in.
+  static uint64_t TagsHash(
+      const std::unordered_map<std::string, std::string> &tags) noexcept;
 
   // ScopeID constructs a unique ID for a scope.
-  static std::string ScopeID(
-      const std::string &prefix,
-      const std::unordered_map<std::string, std::string> &tags);
+  static std::string ScopeID(const std::string &prefix, const TagSet &tags);
 
   // Run is the function used to report metrics from the Scope.
   void Run();
 
-  // Report reports the Scope's metrics to its Reporter.
-  void Report();
-
   const std::string prefix_;
   const std::string separator_;
-  const std::unordered_map<std::string, std::string> tags_;
+  const std::shared_ptr<const TagSet> tags_;
   const std::chrono::nanoseconds interval_;
   std::shared_ptr<StatsReporter> reporter_;
+  const uint32_t counter_stripes_;
+  const uint32_t histogram_shards_;
+  const tally::Timer::Mode timer_mode_;
+  const uint32_t timer_reservoir_size_;
+
+  // The slab which the hot state of the Scope's metrics is allocated from. It
+  // is shared with all of the Scope's subscopes.
+  std::shared_ptr<CellSlab> slab_;
 
   std::thread thread_;
   std::condition_variable cv_;
   std::mutex running_mutex_;
   bool running_;
 
-  std::mutex registry_mutex_;
-  std::unordered_map<std::string, std::shared_ptr<ScopeImpl>> registry_;
-
-  std::mutex counters_mutex_;
-  std::unordered_map<std::string, std::shared_ptr<CounterImpl>> counters_;
-
-  std::mutex gauges_mutex_;
-  std::unordered_map<std::string, std::shared_ptr<GaugeImpl>> gauges_;
-
-  std::mutex timers_mutex_;
-  std::unordered_map<std::string, std::shared_ptr<TimerImpl>> timers_;
-
-  std::mutex histograms_mutex_;
-  std::unordered_map<std::string, std::shared_ptr<HistogramImpl>> histograms_;
+  // The Scope's subscopes by ID, which they are reported from.
+  Registry<ScopeImpl> registry_;
+
+  // The Scope's subscopes by the name they were requested with from SubScope,
+  // and by the tags they were requested with from Tagged, so that requesting
+  // an existing subscope does not need to compute its ID.
+  Registry<ScopeImpl> subscopes_;
+  Registry<TaggedScope> tagged_;
+
+  // The Scope's metrics by name, which can be looked up without locking.
+  // Timers and sketches hold the fully qualified names they report under
+  // themselves, so their registries do not qualify the names.
+  Registry<CounterImpl> counters_;
+  Registry<GaugeImpl> gauges_;
+  Registry<CallbackGaugeImpl> callback_gauges_;
+  Registry<TimerImpl> timers_;
+  Registry<HistogramImpl> histograms_;
+  Registry<SketchImpl> sketches_;
 };
 
 }  // namespace tally
@@ -0,0 +1,54 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/scoped_stopwatch.h"
+
+#include "tally/clock.h"
+
+namespace tally {
+
+ScopedStopwatch::ScopedStopwatch(Timer &timer) noexcept
+    : start_(Clock::Now()),
+      timer_(&timer),
+      histogram_(nullptr) {}
+
+ScopedStopwatch::ScopedStopwatch(Histogram &histogram) noexcept
+    : start_(Clock::Now()),
+      timer_(nullptr),
+      histogram_(&histogram) {}
+
+ScopedStopwatch::~ScopedStopwatch() { Stop(); }
+
+void ScopedStopwatch::Stop() {
+  if (timer_ == nullptr && histogram_ == nullptr) {
+    return;
+  }
+
+  auto const duration = Clock::Now() - start_;
+  if (timer_ != nullptr) {
+    timer_->Record(duration);
+  } else {
+    histogram_->Record(duration);
+  }
+  timer_ = nullptr;
+  histogram_ = nullptr;
+}
+
+}  // namespace tally
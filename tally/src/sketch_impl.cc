@@ -0,0 +1,230 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/sketch_impl.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tally/clock.h"
+#include "tally/src/histogram_bucket.h"
+
+namespace tally {
+
+namespace {
+
+const std::size_t DEFAULT_MAX_BUCKETS = 2048;
+
+// The maximum number of buckets in a sketch's window. At a relative accuracy
+// of 1% the window spans values within a factor of ~20000 of the first value
+// recorded.
+const std::size_t MAX_WINDOW_BUCKETS = 1024;
+
+// The window offset of a sketch whose window has not been anchored yet.
+const int32_t UNANCHORED = std::numeric_limits<int32_t>::min();
+
+const std::vector<double> DEFAULT_QUANTILES = {0.5,  0.75, 0.9,
+                                               0.95, 0.99, 0.999};
+
+// QuantileNames returns the name which each of `quantiles` is reported under,
+// which is `name` and the separator followed by "p" and the percentile without
+// its decimal point, e.g. "p50" for 0.5 and "p999" for 0.999.
+std::vector<std::string> QuantileNames(const std::string &name,
+                                       const std::vector<double> &quantiles,
+                                       const std::string &separator) {
+  std::vector<std::string> names;
+  for (auto const quantile : quantiles) {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(6) << quantile * 100;
+    auto digits = stream.str();
+    digits.erase(digits.find_last_not_of('0') + 1);
+    digits.erase(std::remove(digits.begin(), digits.end(), '.'), digits.end());
+    names.push_back(name + separator + "p" + digits);
+  }
+  return names;
+}
+
+}  // namespace
+
+SketchImpl::SketchImpl(const std::string &name, Buckets::Kind kind,
+                       double relative_accuracy, std::size_t max_buckets,
+                       const std::vector<double> &quantiles,
+                       const std::string &separator)
+    : name_(name),
+      kind_(kind),
+      quantiles_(quantiles),
+      quantile_names_(QuantileNames(name, quantiles, separator)),
+      window_size_(std::min(max_buckets, MAX_WINDOW_BUCKETS)),
+      window_(new std::atomic<uint64_t>[window_size_]()),
+      window_offset_(UNANCHORED),
+      sketch_(relative_accuracy, max_buckets) {
+  for (std::size_t i = 0; i < window_size_; i++) {
+    window_[i].store(0, std::memory_order_relaxed);
+  }
+  sketch_.Reserve();
+}
+
+std::shared_ptr<SketchImpl> SketchImpl::New(const std::string &name,
+                                            Buckets::Kind kind,
+                                            double relative_accuracy,
+                                            const std::string &separator) {
+  return New(name, kind, relative_accuracy, DEFAULT_MAX_BUCKETS,
+             DEFAULT_QUANTILES, separator);
+}
+
+std::shared_ptr<SketchImpl> SketchImpl::New(
+    const std::string &name, Buckets::Kind kind, double relative_accuracy,
+    std::size_t max_buckets, const std::vector<double> &quantiles,
+    const std::string &separator) {
+  return std::shared_ptr<SketchImpl>(new SketchImpl(
+      name, kind, relative_accuracy, max_buckets, quantiles, separator));
+}
+
+void SketchImpl::Record(double value) noexcept {
+  if (TryRecordInWindow(value)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(sketch_mutex_);
+  sketch_.Add(value);
+}
+
+void SketchImpl::Record(std::chrono::nanoseconds value) noexcept {
+  Record(static_cast<double>(value.count()));
+}
+
+void SketchImpl::RecordMany(const double *values, std::size_t num) noexcept {
+  // The mutex is only taken once the batch has a value outside the window.
+  std::unique_lock<std::mutex> lock(sketch_mutex_, std::defer_lock);
+  for (std::size_t i = 0; i < num; i++) {
+    if (!TryRecordInWindow(values[i])) {
+      if (!lock.owns_lock()) {
+        lock.lock();
+      }
+      sketch_.Add(values[i]);
+    }
+  }
+}
+
+void SketchImpl::RecordMany(const std::chrono::nanoseconds *values,
+                            std::size_t num) noexcept {
+  std::unique_lock<std::mutex> lock(sketch_mutex_, std::defer_lock);
+  for (std::size_t i = 0; i < num; i++) {
+    auto const value = static_cast<double>(values[i].count());
+    if (!TryRecordInWindow(value)) {
+      if (!lock.owns_lock()) {
+        lock.lock();
+      }
+      sketch_.Add(value);
+    }
+  }
+}
+
+Stopwatch SketchImpl::Start() noexcept {
+  return Stopwatch(Clock::Now(), shared_from_this());
+}
+
+void SketchImpl::RecordStopwatch(std::chrono::steady_clock::time_point start) {
+  auto const duration = Clock::Now() - start;
+  Record(duration);
+}
+
+bool SketchImpl::TryRecordInWindow(double value) noexcept {
+  int32_t index;
+  if (!sketch_.PositiveIndex(value, &index)) {
+    return false;
+  }
+
+  auto offset = window_offset_.load(std::memory_order_acquire);
+  if (offset == UNANCHORED) {
+    auto const anchored = index - static_cast<int32_t>(window_size_ / 2);
+    if (window_offset_.compare_exchange_strong(offset, anchored,
+                                               std::memory_order_acq_rel)) {
+      offset = anchored;
+    }
+  }
+
+  if (index < offset ||
+      index - offset >= static_cast<int64_t>(window_size_)) {
+    return false;
+  }
+  window_[static_cast<std::size_t>(index - offset)].fetch_add(
+      1, std::memory_order_relaxed);
+  return true;
+}
+
+void SketchImpl::Report(const TagSet &tags, StatsReporter *reporter) {
+  // Take a copy of the interval's sketch so that recording is only blocked for
+  // the duration of the copy rather than the calls to the reporter.
+  std::unique_lock<std::mutex> lock(sketch_mutex_);
+  auto sketch = sketch_;
+  sketch_.Clear();
+  lock.unlock();
+
+  // Values recorded into the window while it is drained are counted towards
+  // either interval.
+  auto const offset = window_offset_.load(std::memory_order_acquire);
+  if (offset != UNANCHORED) {
+    for (std::size_t i = 0; i < window_size_; i++) {
+      auto const count = window_[i].exchange(0, std::memory_order_relaxed);
+      sketch.AddPositive(offset + static_cast<int32_t>(i), count);
+    }
+  }
+
+  if (sketch.Count() == 0) {
+    return;
+  }
+
+  // A window anchored on an outlier leaves the typical values to be recorded
+  // under the lock, so it is recentered on the median of any interval whose
+  // median falls outside its middle half.
+  int32_t median;
+  if (offset != UNANCHORED &&
+      sketch.PositiveIndex(sketch.Quantile(0.5), &median)) {
+    auto const quarter = static_cast<int32_t>(window_size_ / 4);
+    if (median < offset + quarter ||
+        median >= offset + static_cast<int32_t>(window_size_) - quarter) {
+      window_offset_.store(median - static_cast<int32_t>(window_size_ / 2),
+                           std::memory_order_release);
+    }
+  }
+
+  if (reporter == nullptr) {
+    return;
+  }
+
+  auto const num_buckets = sketch.NumBucketIDs();
+  sketch.ForEachBucket([&](uint64_t id, double lower_bound, double upper_bound,
+                           uint64_t samples) {
+    HistogramBucket(kind_, id, num_buckets, lower_bound, upper_bound)
+        .Report(name_, tags, samples, reporter);
+  });
+
+  for (std::size_t i = 0; i < quantiles_.size(); i++) {
+    reporter->ReportGauge(quantile_names_[i], tags,
+                          sketch.Quantile(quantiles_[i]));
+  }
+}
+
+}  // namespace tally
@@ -0,0 +1,129 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tally/buckets.h"
+#include "tally/histogram.h"
+#include "tally/src/dd_sketch.h"
+#include "tally/stats_reporter.h"
+#include "tally/stopwatch.h"
+#include "tally/tag_set.h"
+
+namespace tally {
+
+// SketchImpl is a Histogram which counts values in a DDSketch rather than in
+// fixed buckets, so that it needs no ranges to be chosen ahead of time and
+// reports quantiles within a bounded relative error.
+class SketchImpl : public Histogram,
+                   public StopwatchRecorder,
+                   public std::enable_shared_from_this<StopwatchRecorder> {
+ public:
+  // New is used in place of the default constructor to ensure that callers are
+  // returned a shared pointer to a SketchImpl object since the class inherits
+  // from the std::enable_shared_from_this class. The sketch reports buckets of
+  // the provided `kind` under `name` along with its default quantiles as gauges
+  // under `name` suffixed by `separator` and the quantile, e.g. "p99".
+  static std::shared_ptr<SketchImpl> New(const std::string &name,
+                                         Buckets::Kind kind,
+                                         double relative_accuracy,
+                                         const std::string &separator);
+
+  // New returns a SketchImpl which keeps at most `max_buckets` buckets for
+  // each of its positive and negative values and reports `quantiles`.
+  static std::shared_ptr<SketchImpl> New(const std::string &name,
+                                         Buckets::Kind kind,
+                                         double relative_accuracy,
+                                         std::size_t max_buckets,
+                                         const std::vector<double> &quantiles,
+                                         const std::string &separator);
+
+  // Ensure the class is non-copyable.
+  SketchImpl(const SketchImpl &) = delete;
+
+  SketchImpl &operator=(const SketchImpl &) = delete;
+
+  // Methods to implement the Histogram interface.
+  void Record(double) noexcept;
+
+  void Record(std::chrono::nanoseconds) noexcept;
+
+  void RecordMany(const double *values, std::size_t num) noexcept;
+
+  void RecordMany(const std::chrono::nanoseconds *values,
+                  std::size_t num) noexcept;
+
+  Stopwatch Start() noexcept;
+
+  // Methods to implement the StopwatchRecorder interface.
+  void RecordStopwatch(std::chrono::steady_clock::time_point);
+
+  // Report reports the buckets of the values recorded since the last report
+  // along with their quantiles.
+  void Report(const TagSet &tags, StatsReporter *reporter);
+
+ private:
+  SketchImpl(const std::string &name, Buckets::Kind kind,
+             double relative_accuracy, std::size_t max_buckets,
+             const std::vector<double> &quantiles,
+             const std::string &separator);
+
+  const std::string name_;
+  const Buckets::Kind kind_;
+  const std::vector<double> quantiles_;
+
+  // The names which each quantile is reported under, which are computed once
+  // on construction rather than every time the sketch is reported.
+  const std::vector<std::string> quantile_names_;
+
+  // TryRecordInWindow records a value into the window without locking and
+  // returns true if it falls in the window, anchoring the window on it if no
+  // value has been recorded into the window yet.
+  bool TryRecordInWindow(double value) noexcept;
+
+  // The counts of the window of `window_size_` positive value buckets
+  // beginning at the bucket index `window_offset_`, which are recorded into
+  // without locking and drained into the sketch when it is reported. The
+  // window is centered on the first value recorded into it, and recentered on
+  // the median of an interval when reported if the median lies outside its
+  // middle half. A value recorded concurrently with the window moving may be
+  // counted in the bucket at the same position of the moved window.
+  const std::size_t window_size_;
+  const std::unique_ptr<std::atomic<uint64_t>[]> window_;
+  std::atomic<int32_t> window_offset_;
+
+  // The sketch of the values recorded since the last report which do not fall
+  // in the window, such as zero, negative values and outliers. It is reserved
+  // so that recording into it never allocates, and each record takes the
+  // mutex.
+  std::mutex sketch_mutex_;
+  DDSketch sketch_;
+};
+
+}  // namespace tally
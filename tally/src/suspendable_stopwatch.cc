@@ -0,0 +1,87 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/suspendable_stopwatch.h"
+
+#include "tally/clock.h"
+
+namespace tally {
+
+SuspendableStopwatch::SuspendableStopwatch(Timer &wall, Timer &active) noexcept
+    : start_(Clock::Now()),
+      resumed_(start_),
+      active_(0),
+      state_(State::Active),
+      wall_timer_(&wall),
+      active_timer_(&active),
+      wall_histogram_(nullptr),
+      active_histogram_(nullptr) {}
+
+SuspendableStopwatch::SuspendableStopwatch(Histogram &wall,
+                                           Histogram &active) noexcept
+    : start_(Clock::Now()),
+      resumed_(start_),
+      active_(0),
+      state_(State::Active),
+      wall_timer_(nullptr),
+      active_timer_(nullptr),
+      wall_histogram_(&wall),
+      active_histogram_(&active) {}
+
+SuspendableStopwatch::~SuspendableStopwatch() { Stop(); }
+
+void SuspendableStopwatch::Suspend() noexcept {
+  if (state_ != State::Active) {
+    return;
+  }
+  active_ += Clock::Now() - resumed_;
+  state_ = State::Suspended;
+}
+
+void SuspendableStopwatch::Resume() noexcept {
+  if (state_ != State::Suspended) {
+    return;
+  }
+  resumed_ = Clock::Now();
+  state_ = State::Active;
+}
+
+void SuspendableStopwatch::Stop() {
+  if (state_ == State::Stopped) {
+    return;
+  }
+
+  auto const now = Clock::Now();
+  if (state_ == State::Active) {
+    active_ += now - resumed_;
+  }
+  state_ = State::Stopped;
+
+  auto const wall = now - start_;
+  if (wall_timer_ != nullptr) {
+    wall_timer_->Record(wall);
+    active_timer_->Record(active_);
+  } else {
+    wall_histogram_->Record(wall);
+    active_histogram_->Record(active_);
+  }
+}
+
+}  // namespace tally
@@ -0,0 +1,169 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/tag_set.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tally/src/registry.h"
+
+namespace tally {
+
+namespace {
+
+// Interned holds the interned TagSets by hash. Entries hold weak pointers so
+// that a TagSet is freed once nothing else holds it, at which point it removes
+// its own entry.
+struct Interned {
+  using Entry = std::pair<const TagSet *, std::weak_ptr<const TagSet>>;
+
+  std::mutex mutex;
+  std::unordered_multimap<uint64_t, Entry> sets;
+};
+
+// Since scopes may be constructed and destroyed during static initialization
+// and destruction the interned TagSets are never destroyed.
+Interned &InternedTagSets() {
+  static auto const interned = new Interned();
+  return *interned;
+}
+
+// Release removes the entry of an interned TagSet once nothing holds it, and
+// frees it.
+void Release(const TagSet *set) {
+  auto &interned = InternedTagSets();
+  {
+    std::lock_guard<std::mutex> lock(interned.mutex);
+    auto const range = interned.sets.equal_range(set->hash());
+    for (auto entry = range.first; entry != range.second; entry++) {
+      if (entry->second.first == set) {
+        interned.sets.erase(entry);
+        break;
+      }
+    }
+  }
+  delete set;
+}
+
+bool ByName(const TagSet::Tag &a, const TagSet::Tag &b) {
+  return a.first < b.first;
+}
+
+}  // namespace
+
+TagSet::TagSet(const std::unordered_map<std::string, std::string> &tags)
+    : tags_(Sort(tags)), hash_(Hash(tags_)) {}
+
+TagSet::TagSet(const TagSet &other)
+    : tags_(other.tags_), hash_(other.hash_) {}
+
+TagSet::TagSet(std::vector<Tag> tags, uint64_t hash)
+    : tags_(std::move(tags)), hash_(hash) {}
+
+std::shared_ptr<const TagSet> TagSet::Intern(
+    const std::unordered_map<std::string, std::string> &tags) {
+  return InternSorted(Sort(tags));
+}
+
+std::shared_ptr<const TagSet> TagSet::Merge(
+    const std::unordered_map<std::string, std::string> &tags) const {
+  auto const overrides = Sort(tags);
+
+  std::vector<Tag> merged;
+  merged.reserve(tags_.size() + overrides.size());
+  auto it = tags_.begin();
+  for (auto const &tag : overrides) {
+    for (; it != tags_.end() && it->first < tag.first; it++) {
+      merged.push_back(*it);
+    }
+    if (it != tags_.end() && it->first == tag.first) {
+      it++;
+    }
+    merged.push_back(tag);
+  }
+  merged.insert(merged.end(), it, tags_.end());
+
+  return InternSorted(std::move(merged));
+}
+
+const std::unordered_map<std::string, std::string> &TagSet::AsMap() const {
+  std::call_once(map_once_, [this]() {
+    map_.reset(new std::unordered_map<std::string, std::string>(tags_.begin(),
+                                                                tags_.end()));
+  });
+  return *map_;
+}
+
+bool TagSet::operator==(const TagSet &other) const noexcept {
+  return this == &other || (hash_ == other.hash_ && tags_ == other.tags_);
+}
+
+std::shared_ptr<const TagSet> TagSet::InternSorted(std::vector<Tag> tags) {
+  auto const hash = Hash(tags);
+  auto &interned = InternedTagSets();
+
+  // The TagSets found below may be released by their other holders while this
+  // holds them, so they are declared before the lock so that they are only
+  // freed once it is released, since they take it to remove their entries.
+  std::vector<std::shared_ptr<const TagSet>> found;
+  std::lock_guard<std::mutex> lock(interned.mutex);
+
+  auto const range = interned.sets.equal_range(hash);
+  for (auto entry = range.first; entry != range.second; entry++) {
+    auto set = entry->second.second.lock();
+    if (set != nullptr) {
+      found.push_back(set);
+      if (set->tags_ == tags) {
+        return set;
+      }
+    }
+  }
+
+  std::shared_ptr<const TagSet> set(new TagSet(std::move(tags), hash),
+                                    Release);
+  interned.sets.emplace(hash, std::make_pair(set.get(), set));
+  return set;
+}
+
+std::vector<TagSet::Tag> TagSet::Sort(
+    const std::unordered_map<std::string, std::string> &tags) {
+  std::vector<Tag> sorted(tags.begin(), tags.end());
+  std::sort(sorted.begin(), sorted.end(), ByName);
+  return sorted;
+}
+
+uint64_t TagSet::Hash(const std::vector<Tag> &tags) noexcept {
+  uint64_t hash = tags.size();
+  for (auto const &tag : tags) {
+    hash = (hash ^ HashBytes(tag.first.data(), tag.first.length())) *
+           0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ HashBytes(tag.second.data(), tag.second.length())) *
+           0xFF51AFD7ED558CCDULL;
+  }
+  return hash ^ (hash >> 32);
+}
+
+}  // namespace tally
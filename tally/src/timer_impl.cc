@@ -20,37 +20,300 @@
 
 #include "tally/src/timer_impl.h"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "tally/clock.h"
+#include "tally/src/cache_line.h"
+
 namespace tally {
 
+namespace {
+
+// RandomBelow returns a pseudo-random integer in the range [0, bound) from a
+// generator local to the calling thread, so that sampling threads do not
+// contend on its state. The quality of a xorshift generator is ample for
+// choosing which durations to sample.
+uint64_t RandomBelow(uint64_t bound) noexcept {
+  thread_local uint64_t state =
+      0x9E3779B97F4A7C15ULL * (static_cast<uint64_t>(ThreadIndex()) + 1);
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return (state * 0x2545F4914F6CDD1DULL) % bound;
+}
+
+}  // namespace
+
 TimerImpl::TimerImpl(const std::string &name,
-                     const std::unordered_map<std::string, std::string> &tags,
+                     std::shared_ptr<const TagSet> tags,
                      std::shared_ptr<StatsReporter> reporter) noexcept
-    : name_(name), tags_(tags), reporter_(reporter) {}
+    : name_(name),
+      tags_(std::move(tags)),
+      reporter_(reporter),
+      reservoir_size_(0),
+      writer_mask_(0),
+      writer_cells_(nullptr),
+      seen_cells_(nullptr),
+      current_(0) {}
+
+TimerImpl::TimerImpl(const std::string &name, const Buckets &buckets,
+                     const std::string &separator, uint32_t counter_stripes,
+                     uint32_t histogram_shards,
+                     std::shared_ptr<CellSlab> slab) noexcept
+    : name_(name),
+      count_name_(name + separator + "count"),
+      sum_name_(name + separator + "sum"),
+      min_name_(name + separator + "min"),
+      max_name_(name + separator + "max"),
+      histogram_(HistogramImpl::New(buckets, slab, histogram_shards)),
+      count_(new CounterImpl(counter_stripes, slab)),
+      sum_(new CounterImpl(counter_stripes, slab)),
+      min_(new GaugeImpl(Gauge::Aggregation::Min, slab)),
+      max_(new GaugeImpl(Gauge::Aggregation::Max, slab)),
+      reservoir_size_(0),
+      writer_mask_(0),
+      writer_cells_(nullptr),
+      seen_cells_(nullptr),
+      current_(0) {}
+
+TimerImpl::TimerImpl(const std::string &name, uint32_t reservoir_size,
+                     const std::string &separator, uint32_t counter_stripes,
+                     std::shared_ptr<CellSlab> slab) noexcept
+    : name_(name),
+      count_name_(name + separator + "count"),
+      sum_name_(name + separator + "sum"),
+      sample_rate_name_(name + separator + "sample_rate"),
+      sum_(new CounterImpl(counter_stripes, slab)),
+      reservoir_size_(reservoir_size),
+      reservoirs_{std::unique_ptr<Reservoir>(new Reservoir(reservoir_size)),
+                  std::unique_ptr<Reservoir>(new Reservoir(reservoir_size))},
+      writer_mask_(RoundUpToPowerOfTwo(counter_stripes) - 1),
+      slab_(slab == nullptr ? std::make_shared<CellSlab>(writer_mask_ + 3)
+                            : std::move(slab)),
+      writer_cells_(
+          static_cast<WriterCell *>(slab_->Allocate(writer_mask_ + 1))),
+      seen_cells_(static_cast<SeenCell *>(slab_->Allocate(2))),
+      current_(0) {
+  for (uint32_t i = 0; i <= writer_mask_; i++) {
+    new (&writer_cells_[i]) WriterCell();
+    writer_cells_[i].writers[0].store(0, std::memory_order_relaxed);
+    writer_cells_[i].writers[1].store(0, std::memory_order_relaxed);
+  }
+  for (uint32_t i = 0; i < 2; i++) {
+    new (&seen_cells_[i]) SeenCell();
+    seen_cells_[i].seen.store(0, std::memory_order_relaxed);
+  }
+}
+
+TimerImpl::Reservoir::Reservoir(uint32_t size)
+    : samples(new std::atomic<int64_t>[size]()) {
+  for (uint32_t i = 0; i < size; i++) {
+    samples[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 std::shared_ptr<TimerImpl> TimerImpl::New(
-    const std::string &name,
-    const std::unordered_map<std::string, std::string> &tags,
+    const std::string &name, std::shared_ptr<const TagSet> tags,
     std::shared_ptr<StatsReporter> reporter) noexcept {
   return std::shared_ptr<TimerImpl>(new TimerImpl(name, tags, reporter));
 }
 
+std::shared_ptr<TimerImpl> TimerImpl::New(
+    const std::string &name, const Buckets &buckets,
+    const std::string &separator, uint32_t counter_stripes,
+    uint32_t histogram_shards, std::shared_ptr<CellSlab> slab) noexcept {
+  return std::shared_ptr<TimerImpl>(
+      new TimerImpl(name, buckets, separator, counter_stripes,
+                    histogram_shards, std::move(slab)));
+}
+
+std::shared_ptr<TimerImpl> TimerImpl::New(
+    const std::string &name, uint32_t reservoir_size,
+    const std::string &separator, uint32_t counter_stripes,
+    std::shared_ptr<CellSlab> slab) noexcept {
+  return std::shared_ptr<TimerImpl>(new TimerImpl(
+      name, reservoir_size, separator, counter_stripes, std::move(slab)));
+}
+
 void TimerImpl::Record(std::chrono::nanoseconds value) {
   Record(static_cast<int64_t>(value.count()));
 }
 
 void TimerImpl::Record(int64_t value) {
+  if (histogram_ != nullptr) {
+    histogram_->Record(std::chrono::nanoseconds(value));
+    count_->Inc();
+    sum_->Inc(value);
+    min_->Update(static_cast<double>(value));
+    max_->Update(static_cast<double>(value));
+    return;
+  }
+
+  if (reservoirs_[0] != nullptr) {
+    auto const index = AcquireReservoir();
+    Sample(index, value,
+           seen_cells_[index].seen.fetch_add(1, std::memory_order_relaxed));
+    ReleaseReservoir(index);
+    sum_->Inc(value);
+    return;
+  }
+
   if (reporter_ != nullptr) {
-    reporter_->ReportTimer(name_, tags_, std::chrono::nanoseconds(value));
+    reporter_->ReportTimer(name_, *tags_, std::chrono::nanoseconds(value));
+  }
+}
+
+void TimerImpl::RecordMany(const std::chrono::nanoseconds *values,
+                           std::size_t num) {
+  // A Buffered TimerImpl aggregates the batch locally so that each aggregate
+  // is only updated once.
+  if (histogram_ != nullptr) {
+    if (num == 0) {
+      return;
+    }
+
+    int64_t sum = 0;
+    auto min = std::numeric_limits<int64_t>::max();
+    auto max = std::numeric_limits<int64_t>::min();
+    for (std::size_t i = 0; i < num; i++) {
+      auto const value = static_cast<int64_t>(values[i].count());
+      sum += value;
+      min = std::min(min, value);
+      max = std::max(max, value);
+    }
+
+    histogram_->RecordMany(values, num);
+    count_->Inc(static_cast<int64_t>(num));
+    sum_->Inc(sum);
+    min_->Update(static_cast<double>(min));
+    max_->Update(static_cast<double>(max));
+    return;
+  }
+
+  if (reservoirs_[0] != nullptr) {
+    if (num == 0) {
+      return;
+    }
+
+    // Claim the positions of the whole batch in the interval at once.
+    auto const index = AcquireReservoir();
+    auto const first =
+        seen_cells_[index].seen.fetch_add(num, std::memory_order_relaxed);
+    int64_t sum = 0;
+    for (std::size_t i = 0; i < num; i++) {
+      auto const value = static_cast<int64_t>(values[i].count());
+      Sample(index, value, first + i);
+      sum += value;
+    }
+    ReleaseReservoir(index);
+    sum_->Inc(sum);
+    return;
+  }
+
+  // Timers are not aggregated before they are reported so every value must be
+  // passed to the reporter, but the reporter need only be checked once.
+  if (reporter_ == nullptr) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < num; i++) {
+    reporter_->ReportTimer(name_, *tags_, values[i]);
   }
 }
 
 Stopwatch TimerImpl::Start() {
-  return Stopwatch(std::chrono::steady_clock::now(), shared_from_this());
+  return Stopwatch(Clock::Now(), shared_from_this());
 }
 
 void TimerImpl::RecordStopwatch(std::chrono::steady_clock::time_point start) {
-  auto const duration = std::chrono::steady_clock::now() - start;
+  auto const duration = Clock::Now() - start;
   Record(duration);
 }
 
+uint32_t TimerImpl::AcquireReservoir() noexcept {
+  auto &writers = writer_cells_[ThreadIndex() & writer_mask_].writers;
+  while (true) {
+    auto const index = current_.load(std::memory_order_seq_cst);
+    writers[index].fetch_add(1, std::memory_order_seq_cst);
+
+    // The reservoir may have been swapped out before the writer registered, in
+    // which case the reporter may already be reading it.
+    if (current_.load(std::memory_order_seq_cst) == index) {
+      return index;
+    }
+    writers[index].fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void TimerImpl::ReleaseReservoir(uint32_t index) noexcept {
+  writer_cells_[ThreadIndex() & writer_mask_].writers[index].fetch_sub(
+      1, std::memory_order_release);
+}
+
+void TimerImpl::Sample(uint32_t index, int64_t value,
+                       uint64_t position) noexcept {
+  auto const slot =
+      position < reservoir_size_ ? position : RandomBelow(position + 1);
+  if (slot < reservoir_size_) {
+    reservoirs_[index]->samples[slot].store(value, std::memory_order_relaxed);
+  }
+}
+
+void TimerImpl::Report(const TagSet &tags, StatsReporter *reporter) {
+  if (reservoirs_[0] != nullptr) {
+    ReportSamples(tags, reporter);
+    return;
+  }
+
+  if (histogram_ == nullptr) {
+    return;
+  }
+
+  histogram_->Report(name_, tags, reporter);
+  count_->Report(count_name_, tags, reporter);
+  sum_->Report(sum_name_, tags, reporter);
+  min_->Report(min_name_, tags, reporter);
+  max_->Report(max_name_, tags, reporter);
+}
+
+void TimerImpl::ReportSamples(const TagSet &tags, StatsReporter *reporter) {
+  std::lock_guard<std::mutex> lock(report_mutex_);
+
+  // Swap the reservoirs and wait for the recorders writing to the previous one
+  // to finish, after which nothing else writes to it until it is swapped back.
+  auto const index = current_.load(std::memory_order_relaxed);
+  current_.store(1 - index, std::memory_order_seq_cst);
+  for (uint32_t i = 0; i <= writer_mask_; i++) {
+    while (writer_cells_[i].writers[index].load(std::memory_order_seq_cst) !=
+           0) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto const &reservoir = *reservoirs_[index];
+  auto const seen =
+      seen_cells_[index].seen.exchange(0, std::memory_order_relaxed);
+  sum_->Report(sum_name_, tags, reporter);
+  if (seen == 0 || reporter == nullptr) {
+    return;
+  }
+
+  auto const sampled = std::min<uint64_t>(seen, reservoir_size_);
+  for (uint64_t i = 0; i < sampled; i++) {
+    reporter->ReportTimer(
+        name_, tags,
+        std::chrono::nanoseconds(
+            reservoir.samples[i].load(std::memory_order_relaxed)));
+  }
+  reporter->ReportCounter(count_name_, tags, static_cast<int64_t>(seen));
+  reporter->ReportGauge(
+      sample_rate_name_, tags,
+      static_cast<double>(sampled) / static_cast<double>(seen));
+}
+
 }  // namespace tally
@@ -20,11 +20,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
 
+#include "tally/buckets.h"
+#include "tally/src/cache_line.h"
+#include "tally/src/cell_slab.h"
+#include "tally/src/counter_impl.h"
+#include "tally/src/gauge_impl.h"
+#include "tally/src/histogram_impl.h"
 #include "tally/stats_reporter.h"
 #include "tally/stopwatch.h"
+#include "tally/tag_set.h"
 #include "tally/timer.h"
 
 namespace tally {
@@ -37,10 +49,28 @@ class TimerImpl : public Timer,
   // returned a shared pointer to a TimerImpl object since the class
   // inherits from the std::enable_shared_from_this class.
   static std::shared_ptr<TimerImpl> New(
-      const std::string &name,
-      const std::unordered_map<std::string, std::string> &tags,
+      const std::string &name, std::shared_ptr<const TagSet> tags,
       std::shared_ptr<StatsReporter> reporter) noexcept;
 
+  // New returns a Buffered TimerImpl, which records durations into a histogram
+  // with the provided `buckets` and into counters and gauges which track their
+  // count, sum, minimum and maximum, all allocated from `slab`. Nothing is
+  // passed to a reporter until Report is called.
+  static std::shared_ptr<TimerImpl> New(
+      const std::string &name, const Buckets &buckets,
+      const std::string &separator, uint32_t counter_stripes,
+      uint32_t histogram_shards, std::shared_ptr<CellSlab> slab) noexcept;
+
+  // New returns a Sampled TimerImpl, which keeps a reservoir of up to
+  // `reservoir_size` of the durations recorded in each reporting interval,
+  // chosen uniformly at random, and counters which track their exact count and
+  // sum, allocated from `slab`. Nothing is passed to a reporter until Report is
+  // called.
+  static std::shared_ptr<TimerImpl> New(
+      const std::string &name, uint32_t reservoir_size,
+      const std::string &separator, uint32_t counter_stripes,
+      std::shared_ptr<CellSlab> slab) noexcept;
+
   // Ensure the class is non-copyable.
   TimerImpl(const TimerImpl &) = delete;
 
@@ -51,19 +81,120 @@ class TimerImpl : public Timer,
 
   void Record(int64_t);
 
+  void RecordMany(const std::chrono::nanoseconds *values, std::size_t num);
+
   Stopwatch Start();
 
   // Methods to implement the StopwatchRecorder interface.
   void RecordStopwatch(std::chrono::steady_clock::time_point);
 
+  // Report reports the durations recorded since the last report by a Buffered
+  // TimerImpl, with the histogram reported under its name and the count, sum,
+  // minimum and maximum reported under its name suffixed by the separator and
+  // "count", "sum", "min" and "max" respectively. A Sampled TimerImpl reports
+  // each sampled duration as a timer under its name, and the count, sum and
+  // the fraction of durations which were sampled under its name suffixed by
+  // the separator and "count", "sum" and "sample_rate" respectively. It is a
+  // no-op for Immediate TimerImpls.
+  void Report(const TagSet &tags, StatsReporter *reporter);
+
  private:
-  TimerImpl(const std::string &name,
-            const std::unordered_map<std::string, std::string> &tags,
+  TimerImpl(const std::string &name, std::shared_ptr<const TagSet> tags,
             std::shared_ptr<StatsReporter> reporter) noexcept;
 
+  TimerImpl(const std::string &name, const Buckets &buckets,
+            const std::string &separator, uint32_t counter_stripes,
+            uint32_t histogram_shards, std::shared_ptr<CellSlab> slab) noexcept;
+
+  TimerImpl(const std::string &name, uint32_t reservoir_size,
+            const std::string &separator, uint32_t counter_stripes,
+            std::shared_ptr<CellSlab> slab) noexcept;
+
+  // Reservoir holds the durations sampled in one reporting interval.
+  struct Reservoir {
+    explicit Reservoir(uint32_t size);
+
+    const std::unique_ptr<std::atomic<int64_t>[]> samples;
+  };
+
+  // WriterCell counts the recorders on one stripe of threads which are
+  // currently writing to each reservoir. Each cell is padded to fill a cache
+  // line so that recorders on different stripes do not contend.
+  struct alignas(CACHE_LINE_SIZE) WriterCell {
+    std::atomic<uint64_t> writers[2];
+  };
+
+  static_assert(sizeof(WriterCell) == CACHE_LINE_SIZE,
+                "Writer cells must occupy exactly one cache line");
+
+  // SeenCell counts the durations recorded in a reservoir's interval, which
+  // every recorder increments, on a cache line of its own.
+  struct alignas(CACHE_LINE_SIZE) SeenCell {
+    std::atomic<uint64_t> seen;
+  };
+
+  static_assert(sizeof(SeenCell) == CACHE_LINE_SIZE,
+                "Seen cells must occupy exactly one cache line");
+
+  // AcquireReservoir registers the caller as a writer of the current
+  // reservoir and returns its index. The caller must call ReleaseReservoir
+  // with the index once it is done writing to it.
+  uint32_t AcquireReservoir() noexcept;
+
+  void ReleaseReservoir(uint32_t index) noexcept;
+
+  // Sample offers `reservoir` a duration which was recorded at the provided
+  // zero-based position within its interval.
+  void Sample(uint32_t index, int64_t value, uint64_t position) noexcept;
+
+  // ReportSamples reports the contents of a Sampled TimerImpl's reservoir and
+  // empties it.
+  void ReportSamples(const TagSet &tags, StatsReporter *reporter);
+
+  // The name which the TimerImpl reports durations under, and the tags and
+  // reporter which an Immediate TimerImpl reports each duration with.
   const std::string name_;
-  const std::unordered_map<std::string, std::string> tags_;
+  const std::shared_ptr<const TagSet> tags_;
   std::shared_ptr<StatsReporter> reporter_;
+
+  // The names which a Buffered or Sampled TimerImpl reports its aggregates
+  // under, which are computed once on construction rather than every time it
+  // is reported. Each is empty unless the TimerImpl reports it.
+  const std::string count_name_;
+  const std::string sum_name_;
+  const std::string min_name_;
+  const std::string max_name_;
+  const std::string sample_rate_name_;
+
+  // The aggregates of a Buffered TimerImpl, which are null for an Immediate
+  // TimerImpl. Durations are recorded in nanoseconds.
+  const std::shared_ptr<HistogramImpl> histogram_;
+  const std::unique_ptr<CounterImpl> count_;
+  const std::unique_ptr<CounterImpl> sum_;
+  const std::unique_ptr<GaugeImpl> min_;
+  const std::unique_ptr<GaugeImpl> max_;
+
+  // The reservoirs of a Sampled TimerImpl, which are null otherwise. A Sampled
+  // TimerImpl also uses `sum_`. Each of the first `reservoir_size_` durations
+  // of an interval is placed in the current reservoir and each later duration
+  // replaces a random one with probability `reservoir_size_ / seen`, so that
+  // the reservoir is always a uniform sample of the interval's durations.
+  //
+  // Reporting swaps the current reservoir for the other one and waits for the
+  // recorders still writing to the previous one to finish before reading it,
+  // so that every sample it reports was written in the interval it reports.
+  // Durations recorded while the TimerImpl is being reported may be counted
+  // towards either interval. The writer counts are striped by thread like a
+  // CounterImpl's cells and allocated from `slab_` along with the seen counts,
+  // so recorders on different threads only share the seen count's cache line.
+  const uint32_t reservoir_size_;
+  const std::unique_ptr<Reservoir> reservoirs_[2];
+  const uint32_t writer_mask_;
+  std::shared_ptr<CellSlab> slab_;
+  WriterCell *writer_cells_;
+  SeenCell *seen_cells_;
+  std::atomic<uint32_t> current_;
+  std::mutex report_mutex_;
 };
 
 }  // namespace tally
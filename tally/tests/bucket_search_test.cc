@@ -0,0 +1,93 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "tally/src/bucket_search.h"
+
+namespace {
+
+std::vector<tally::BucketSearch::Instructions> SupportedInstructions() {
+  std::vector<tally::BucketSearch::Instructions> supported;
+  for (auto const instructions : {tally::BucketSearch::Instructions::Scalar,
+                                  tally::BucketSearch::Instructions::SSE2,
+                                  tally::BucketSearch::Instructions::AVX2}) {
+    if (tally::BucketSearch::Supports(instructions)) {
+      supported.push_back(instructions);
+    }
+  }
+  return supported;
+}
+
+void ExpectMatchesBinarySearch(const std::vector<double> &bounds) {
+  std::vector<double> values(bounds);
+  for (auto const bound : bounds) {
+    values.push_back(std::nextafter(bound, -1e300));
+    values.push_back(std::nextafter(bound, 1e300));
+  }
+  values.push_back(-std::numeric_limits<double>::infinity());
+  values.push_back(std::numeric_limits<double>::infinity());
+  values.push_back(std::nan(""));
+
+  for (auto const instructions : SupportedInstructions()) {
+    tally::BucketSearch search(bounds, instructions);
+    for (auto const value : values) {
+      auto const expected =
+          std::upper_bound(bounds.begin(), bounds.end(), value) -
+          bounds.begin();
+      EXPECT_EQ(expected, search.Find(value))
+          << "value " << value << " with " << bounds.size() << " bounds";
+    }
+  }
+}
+
+}  // namespace
+
+TEST(BucketSearchTest, ScalarIsAlwaysSupported) {
+  EXPECT_TRUE(
+      tally::BucketSearch::Supports(tally::BucketSearch::Instructions::Scalar));
+  EXPECT_TRUE(tally::BucketSearch::Supports(tally::BucketSearch::Best()));
+}
+
+TEST(BucketSearchTest, MatchesBinarySearch) {
+  // Cover layouts smaller than, equal to and spanning multiple blocks, and
+  // those whose blocks are binary searched.
+  for (auto const num :
+       {1, 2, 5, 15, 16, 17, 31, 32, 33, 64, 100, 128, 256, 257, 300, 1000}) {
+    std::vector<double> bounds;
+    double bound = -3.5;
+    for (auto i = 0; i < num; i++) {
+      bounds.push_back(bound);
+      bound += 0.25 + (i % 7) * 1.5;
+    }
+    ExpectMatchesBinarySearch(bounds);
+  }
+}
+
+TEST(BucketSearchTest, InfiniteBound) {
+  ExpectMatchesBinarySearch(
+      {1.0, 2.0, 3.0, std::numeric_limits<double>::infinity()});
+}
@@ -18,6 +18,14 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "tally/buckets.h"
@@ -75,3 +83,114 @@ TEST(BucketsTest, Size) {
   auto exponential_buckets = tally::Buckets::ExponentialValues(1.0, 2.0, 10);
   EXPECT_EQ(10, exponential_buckets.size());
 }
+
+TEST(BucketsTest, CalculatorIndexIsWithinOneOfBinarySearch) {
+  std::vector<tally::Buckets> layouts({
+      tally::Buckets::LinearValues(-5.0, 0.1, 200),
+      tally::Buckets::ExponentialValues(0.001, 2.0, 40),
+      tally::Buckets::ExponentialValues(0.5, 1.5, 60),
+  });
+
+  for (auto const &buckets : layouts) {
+    std::vector<double> bounds(buckets.begin(), buckets.end());
+    auto const calculator = buckets.calculator();
+    ASSERT_TRUE(calculator.HasClosedFormIndex());
+
+    std::vector<double> values(bounds);
+    for (double v = -10.0; v < 1e9; v = v < 1 ? v + 0.01 : v * 1.01) {
+      values.push_back(v);
+    }
+
+    for (auto const v : values) {
+      auto const expected = static_cast<int64_t>(
+          std::upper_bound(bounds.begin(), bounds.end(), v) - bounds.begin());
+      auto const actual =
+          static_cast<int64_t>(calculator.Index(v, bounds.size()));
+      EXPECT_LE(std::abs(expected - actual), 1) << v;
+    }
+  }
+}
+
+TEST(BucketsTest, CalculatorIndexOfNaNIsPastEveryBound) {
+  auto buckets = tally::Buckets::ExponentialValues(1.0, 2.0, 10);
+  EXPECT_EQ(10, buckets.calculator().Index(std::nan(""), 10));
+}
+
+TEST(BucketsTest, CalculatorWithoutClosedFormIndex) {
+  EXPECT_FALSE(tally::Buckets::ExponentialValues(0.0, 2.0, 10)
+                   .calculator()
+                   .HasClosedFormIndex());
+  EXPECT_FALSE(tally::Buckets::ExponentialValues(-1.0, 2.0, 10)
+                   .calculator()
+                   .HasClosedFormIndex());
+}
+
+TEST(BucketsTest, CustomValues) {
+  std::vector<double> bounds({0.5, 1.0, 10.0, 250.0});
+  auto buckets = tally::Buckets::CustomValues(bounds);
+
+  EXPECT_EQ(tally::Buckets::Kind::Values, buckets.kind());
+  EXPECT_EQ(4, buckets.size());
+  EXPECT_EQ(bounds, std::vector<double>(buckets.begin(), buckets.end()));
+  EXPECT_FALSE(buckets.calculator().HasClosedFormIndex());
+}
+
+TEST(BucketsTest, CustomDurations) {
+  auto buckets = tally::Buckets::CustomDurations(
+      {std::chrono::milliseconds(1), std::chrono::milliseconds(5)});
+
+  EXPECT_EQ(tally::Buckets::Kind::Durations, buckets.kind());
+  EXPECT_EQ(std::vector<double>({1e6, 5e6}),
+            std::vector<double>(buckets.begin(), buckets.end()));
+}
+
+TEST(BucketsTest, CustomValuesMustAscend) {
+  EXPECT_THROW(tally::Buckets::CustomValues({}), std::invalid_argument);
+  EXPECT_THROW(tally::Buckets::CustomValues({1.0, 1.0}),
+               std::invalid_argument);
+  EXPECT_THROW(tally::Buckets::CustomValues({2.0, 1.0}),
+               std::invalid_argument);
+}
+
+TEST(BucketsTest, LogLinearBounds) {
+  auto buckets = tally::Buckets::LogLinearValues(2, 40);
+
+  // Each power of two from four onwards is split into four buckets.
+  EXPECT_EQ(std::vector<double>({1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20,
+                                 24, 28, 32, 40, 48}),
+            std::vector<double>(buckets.begin(), buckets.end()));
+  EXPECT_TRUE(buckets.calculator().HasClosedFormIndex());
+  EXPECT_TRUE(buckets.calculator().HasIntegerIndex());
+}
+
+TEST(BucketsTest, LogLinearIndexMatchesBinarySearch) {
+  for (auto const bits : {1u, 3u, 7u}) {
+    auto buckets = tally::Buckets::LogLinearDurations(
+        bits, std::chrono::seconds(100));
+    std::vector<double> bounds(buckets.begin(), buckets.end());
+    auto const calculator = buckets.calculator();
+
+    std::vector<int64_t> values({-5, 0, 1, 2, 3, 127, 128, 129});
+    for (int64_t v = 1; v < 200000000000; v = v * 3 / 2 + 1) {
+      values.push_back(v);
+      values.push_back(v - 1);
+    }
+
+    for (auto const v : values) {
+      auto const expected = static_cast<uint64_t>(
+          std::upper_bound(bounds.begin(), bounds.end(),
+                           static_cast<double>(v)) -
+          bounds.begin());
+      EXPECT_EQ(expected, calculator.IntegerIndex(v, bounds.size())) << v;
+      EXPECT_EQ(expected,
+                calculator.Index(static_cast<double>(v), bounds.size()))
+          << v;
+    }
+  }
+}
+
+TEST(BucketsTest, LogLinearSignificantBitsMustBeInRange) {
+  EXPECT_THROW(tally::Buckets::LogLinearValues(0, 100), std::invalid_argument);
+  EXPECT_THROW(tally::Buckets::LogLinearValues(21, 100),
+               std::invalid_argument);
+}
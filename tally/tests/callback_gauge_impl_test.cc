@@ -0,0 +1,87 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <functional>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+#include "mock_stats_reporter.h"
+#include "tally/src/callback_gauge_impl.h"
+
+TEST(CallbackGaugeImplTest, ReportsCallbackValue) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 1.5)).Times(1);
+
+  tally::CallbackGaugeImpl gauge([]() { return 1.5; });
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(CallbackGaugeImplTest, CallbackIsInvokedOnEachReport) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  double value = 1.0;
+
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 1.0)).Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 2.0)).Times(2);
+
+  tally::CallbackGaugeImpl gauge([&value]() { return value; });
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  value = 2.0;
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(CallbackGaugeImplTest, EmptyCallbackIsNotReported) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportGauge(testing::_, testing::_, testing::_))
+      .Times(0);
+
+  tally::CallbackGaugeImpl gauge{std::function<double()>()};
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(CallbackGaugeImplTest, ThrowingCallbackIsNotReported) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  auto fail = true;
+
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 1.0)).Times(1);
+
+  tally::CallbackGaugeImpl gauge([&fail]() -> double {
+    if (fail) {
+      throw std::runtime_error("unavailable");
+    }
+    return 1.0;
+  });
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  fail = false;
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdint>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#include "tally/src/cache_line.h"
+#include "tally/src/cell_slab.h"
+
+TEST(CellSlabTest, AllocationsAreAligned) {
+  tally::CellSlab slab(4);
+  for (auto i = 0; i < 10; i++) {
+    auto const address = reinterpret_cast<uintptr_t>(slab.Allocate(1));
+    EXPECT_EQ(0, address % tally::CACHE_LINE_SIZE);
+  }
+}
+
+TEST(CellSlabTest, AllocationsAreZeroed) {
+  tally::CellSlab slab(4);
+  auto const allocation = static_cast<char *>(slab.Allocate(2));
+  for (std::size_t i = 0; i < 2 * tally::CACHE_LINE_SIZE; i++) {
+    EXPECT_EQ(0, allocation[i]);
+  }
+}
+
+TEST(CellSlabTest, AllocationsDoNotShareCacheLines) {
+  tally::CellSlab slab(8);
+  std::set<uintptr_t> lines;
+  for (auto i = 0; i < 20; i++) {
+    auto const address = reinterpret_cast<uintptr_t>(slab.Allocate(1));
+    EXPECT_TRUE(lines.insert(address / tally::CACHE_LINE_SIZE).second);
+  }
+}
+
+TEST(CellSlabTest, AllocationsLargerThanAChunk) {
+  tally::CellSlab slab(2);
+  auto const first = static_cast<char *>(slab.Allocate(5));
+  auto const second = static_cast<char *>(slab.Allocate(1));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(first) % tally::CACHE_LINE_SIZE);
+  EXPECT_TRUE(second < first || second >= first + 5 * tally::CACHE_LINE_SIZE);
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/clock.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+TEST(ClockTest, SteadyByDefault) {
+  EXPECT_EQ(tally::Clock::Source::Steady, tally::Clock::source());
+}
+
+TEST(ClockTest, TSCTracksSteadyClock) {
+  if (!tally::Clock::Use(tally::Clock::Source::TSC)) {
+    // The TSC is unsupported here, so the steady clock must remain in use.
+    EXPECT_EQ(tally::Clock::Source::Steady, tally::Clock::source());
+    return;
+  }
+  EXPECT_EQ(tally::Clock::Source::TSC, tally::Clock::source());
+
+  auto const steady_start = std::chrono::steady_clock::now();
+  auto const start = tally::Clock::Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto const end = tally::Clock::Now();
+  auto const steady_end = std::chrono::steady_clock::now();
+
+  // The TSC is calibrated against the steady clock, so both should agree on
+  // the instant and on the duration within a few percent.
+  auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      end - start);
+  auto const steady_elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(steady_end -
+                                                            steady_start);
+  EXPECT_GT(end, start);
+  EXPECT_NEAR(steady_elapsed.count(), elapsed.count(),
+              steady_elapsed.count() / 20);
+  auto const offset = std::chrono::duration_cast<std::chrono::microseconds>(
+      start - steady_start);
+  EXPECT_LT(std::llabs(offset.count()), 5000);
+
+  EXPECT_TRUE(tally::Clock::Use(tally::Clock::Source::Steady));
+  EXPECT_EQ(tally::Clock::Source::Steady, tally::Clock::source());
+}
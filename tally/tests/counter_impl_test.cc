@@ -18,6 +18,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "mock_stats_reporter.h"
@@ -32,7 +35,7 @@ TEST(CounterImplTest, IncrementOnce) {
 
   tally::CounterImpl counter;
   counter.Inc(1);
-  counter.Report(name, tags, reporter.get());
+  counter.Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(CounterImplTest, IncrementMultipleTimes) {
@@ -45,7 +48,7 @@ TEST(CounterImplTest, IncrementMultipleTimes) {
   tally::CounterImpl counter;
   counter.Inc(1);
   counter.Inc(2);
-  counter.Report(name, tags, reporter.get());
+  counter.Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(CounterImplTest, ValueIsReset) {
@@ -58,8 +61,51 @@ TEST(CounterImplTest, ValueIsReset) {
 
   tally::CounterImpl counter;
   counter.Inc(1);
-  counter.Report(name, tags, reporter.get());
+  counter.Report(name, tally::TagSet(tags), reporter.get());
+
+  counter.Inc(2);
+  counter.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(CounterImplTest, StripedIncrementMultipleTimes) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 3)).Times(1);
 
+  tally::CounterImpl counter(8);
+  counter.Inc(1);
   counter.Inc(2);
-  counter.Report(name, tags, reporter.get());
+  counter.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(CounterImplTest, StripedIncrementFromMultipleThreads) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  auto const num_threads = 16;
+  auto const increments = 1000;
+
+  EXPECT_CALL(*reporter.get(),
+              ReportCounter(name, tags, num_threads * increments))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 1)).Times(1);
+
+  tally::CounterImpl counter(4);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < num_threads; i++) {
+    threads.push_back(std::thread([&counter]() {
+      for (auto j = 0; j < increments; j++) {
+        counter.Inc();
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  counter.Report(name, tally::TagSet(tags), reporter.get());
+
+  counter.Inc();
+  counter.Report(name, tally::TagSet(tags), reporter.get());
 }
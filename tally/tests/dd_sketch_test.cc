@@ -0,0 +1,155 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "tally/src/dd_sketch.h"
+
+namespace {
+
+// ExactQuantile returns the quantile of `sorted` using the same rank as the
+// sketch.
+double ExactQuantile(const std::vector<double> &sorted, double quantile) {
+  auto const rank = static_cast<std::size_t>(
+      std::floor(quantile * static_cast<double>(sorted.size() - 1)));
+  return sorted[rank];
+}
+
+}  // namespace
+
+TEST(DDSketchTest, EmptyQuantileIsNaN) {
+  tally::DDSketch sketch(0.01, 2048);
+  EXPECT_TRUE(std::isnan(sketch.Quantile(0.5)));
+  EXPECT_EQ(0, sketch.Count());
+}
+
+TEST(DDSketchTest, QuantilesAreWithinRelativeAccuracy) {
+  auto const accuracy = 0.01;
+  tally::DDSketch sketch(accuracy, 2048);
+  std::mt19937 generator(1);
+  std::lognormal_distribution<double> distribution(10, 2);
+  std::vector<double> values;
+  for (auto i = 0; i < 100000; i++) {
+    values.push_back(distribution(generator) - 1000);
+    sketch.Add(values.back());
+  }
+  std::sort(values.begin(), values.end());
+
+  EXPECT_EQ(values.size(), sketch.Count());
+  for (auto const quantile : {0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+    auto const expected = ExactQuantile(values, quantile);
+    EXPECT_NEAR(expected, sketch.Quantile(quantile),
+                std::abs(expected) * accuracy)
+        << "quantile " << quantile;
+  }
+}
+
+TEST(DDSketchTest, ZeroAndNaN) {
+  tally::DDSketch sketch(0.01, 2048);
+  sketch.Add(0, 3);
+  sketch.Add(std::nan(""));
+  sketch.Add(5);
+
+  EXPECT_EQ(4, sketch.Count());
+  EXPECT_EQ(0, sketch.Quantile(0.5));
+  EXPECT_NEAR(5, sketch.Quantile(1), 0.05);
+}
+
+TEST(DDSketchTest, CollapsingBoundsBucketsAndKeepsTail) {
+  tally::DDSketch sketch(0.01, 64);
+  auto max = 0.0;
+  for (auto value = 1.0; value < 1e9; value *= 1.01) {
+    sketch.Add(value);
+    max = value;
+  }
+
+  uint64_t num_buckets = 0;
+  uint64_t count = 0;
+  sketch.ForEachBucket([&](uint64_t, double, double, uint64_t samples) {
+    num_buckets++;
+    count += samples;
+  });
+  EXPECT_LE(num_buckets, 64);
+  EXPECT_EQ(sketch.Count(), count);
+  EXPECT_NEAR(max, sketch.Quantile(1), max * 0.01);
+}
+
+TEST(DDSketchTest, BucketsAscendAndContainTheirValues) {
+  tally::DDSketch sketch(0.02, 2048);
+  std::vector<double> values({-300, -2.5, 0, 1e-3, 7, 7.01, 1e6});
+  for (auto const value : values) {
+    sketch.Add(value);
+  }
+
+  std::vector<uint64_t> ids;
+  double previous_upper = -1e300;
+  sketch.ForEachBucket([&](uint64_t id, double lower, double upper, uint64_t) {
+    ids.push_back(id);
+    EXPECT_LT(lower, upper);
+    EXPECT_LE(previous_upper, lower);
+    EXPECT_LT(id, sketch.NumBucketIDs());
+    previous_upper = upper;
+  });
+  EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+  EXPECT_EQ(values.size() - 1, ids.size());
+}
+
+TEST(DDSketchTest, Merge) {
+  tally::DDSketch first(0.01, 2048);
+  tally::DDSketch second(0.01, 2048);
+  tally::DDSketch both(0.01, 2048);
+  for (auto i = 1; i <= 1000; i++) {
+    (i % 2 == 0 ? first : second).Add(i);
+    both.Add(i);
+  }
+
+  first.Merge(second);
+  EXPECT_EQ(both.Count(), first.Count());
+  for (auto const quantile : {0.0, 0.25, 0.5, 0.99, 1.0}) {
+    EXPECT_EQ(both.Quantile(quantile), first.Quantile(quantile));
+  }
+
+  tally::DDSketch other(0.05, 2048);
+  EXPECT_THROW(first.Merge(other), std::invalid_argument);
+}
+
+TEST(DDSketchTest, InvalidArguments) {
+  EXPECT_THROW(tally::DDSketch(0, 2048), std::invalid_argument);
+  EXPECT_THROW(tally::DDSketch(1, 2048), std::invalid_argument);
+  EXPECT_THROW(tally::DDSketch(0.01, 0), std::invalid_argument);
+}
+
+TEST(DDSketchTest, AccuracyTooFineToIndex) {
+  EXPECT_THROW(tally::DDSketch(1e-8, 2048), std::invalid_argument);
+  EXPECT_THROW(tally::DDSketch(1e-17, 2048), std::invalid_argument);
+
+  tally::DDSketch sketch(1e-6, 2048);
+  sketch.Add(std::numeric_limits<double>::max());
+  sketch.Add(std::numeric_limits<double>::min());
+  EXPECT_EQ(2u, sketch.Count());
+}
@@ -18,6 +18,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "mock_stats_reporter.h"
@@ -32,7 +35,7 @@ TEST(GaugeImplTest, UpdateOnce) {
 
   tally::GaugeImpl gauge;
   gauge.Update(1.5);
-  gauge.Report(name, tags, reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(GaugeImplTest, UpdateMultipleTimes) {
@@ -45,7 +48,7 @@ TEST(GaugeImplTest, UpdateMultipleTimes) {
   tally::GaugeImpl gauge;
   gauge.Update(1.5);
   gauge.Update(2.25);
-  gauge.Report(name, tags, reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(GaugeImplTest, ValueIsReset) {
@@ -57,8 +60,104 @@ TEST(GaugeImplTest, ValueIsReset) {
 
   tally::GaugeImpl gauge;
   gauge.Update(1.5);
-  gauge.Report(name, tags, reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
 
   gauge.Update(2.25);
-  gauge.Report(name, tags, reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(GaugeImplTest, MaxAggregation) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 3.0)).Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, -2.0)).Times(1);
+
+  tally::GaugeImpl gauge(tally::Gauge::Aggregation::Max);
+  gauge.Update(1.0);
+  gauge.Update(3.0);
+  gauge.Update(2.0);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  // The maximum is reset after each report.
+  gauge.Update(-2.0);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  // Nothing is reported if the gauge was not updated.
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(GaugeImplTest, MinAggregation) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 1.0)).Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 5.0)).Times(1);
+
+  tally::GaugeImpl gauge(tally::Gauge::Aggregation::Min);
+  gauge.Update(2.0);
+  gauge.Update(1.0);
+  gauge.Update(3.0);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  gauge.Update(5.0);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(GaugeImplTest, SumAggregation) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 4.5)).Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 2.0)).Times(1);
+
+  tally::GaugeImpl gauge(tally::Gauge::Aggregation::Sum);
+  gauge.Update(1.5);
+  gauge.Update(3.0);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  gauge.Update(2.0);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(GaugeImplTest, SumAggregationOfZeroIsReported) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportGauge(name, tags, 0.0)).Times(1);
+
+  tally::GaugeImpl gauge(tally::Gauge::Aggregation::Sum);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+
+  gauge.Update(1.5);
+  gauge.Update(-1.5);
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(GaugeImplTest, MaxAggregationFromMultipleThreads) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  auto const num_threads = 8;
+  auto const updates = 1000;
+  EXPECT_CALL(*reporter.get(),
+              ReportGauge(name, tags, num_threads * updates - 1))
+      .Times(1);
+
+  tally::GaugeImpl gauge(tally::Gauge::Aggregation::Max);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < num_threads; i++) {
+    threads.push_back(std::thread([&gauge, i]() {
+      for (auto j = 0; j < updates; j++) {
+        gauge.Update(j * num_threads + i);
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  gauge.Report(name, tally::TagSet(tags), reporter.get());
 }
@@ -19,11 +19,17 @@
 // THE SOFTWARE.
 
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 #include "mock_stats_reporter.h"
 #include "tally/buckets.h"
+#include "tally/src/histogram_bucket.h"
 #include "tally/src/histogram_impl.h"
 
 TEST(HistogramImplTest, RecordValueOnce) {
@@ -38,7 +44,7 @@ TEST(HistogramImplTest, RecordValueOnce) {
 
   auto histogram = tally::HistogramImpl::New(buckets);
   histogram->Record(value);
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, RecordDurationOnce) {
@@ -56,7 +62,7 @@ TEST(HistogramImplTest, RecordDurationOnce) {
 
   auto histogram = tally::HistogramImpl::New(buckets);
   histogram->Record(duration);
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, RecordValueMultipleTimes) {
@@ -72,7 +78,7 @@ TEST(HistogramImplTest, RecordValueMultipleTimes) {
   auto histogram = tally::HistogramImpl::New(buckets);
   histogram->Record(value);
   histogram->Record(value);
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, RecordDurationMultipleTimes) {
@@ -91,7 +97,7 @@ TEST(HistogramImplTest, RecordDurationMultipleTimes) {
   auto histogram = tally::HistogramImpl::New(buckets);
   histogram->Record(duration);
   histogram->Record(duration);
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, RecordValueMultipleTimesWithMultipleBuckets) {
@@ -111,7 +117,7 @@ TEST(HistogramImplTest, RecordValueMultipleTimesWithMultipleBuckets) {
   histogram->Record(first_value);
   histogram->Record(second_value);
   histogram->Record(second_value);
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, RecordDurationMultipleTimesWithMultipleBuckets) {
@@ -136,7 +142,7 @@ TEST(HistogramImplTest, RecordDurationMultipleTimesWithMultipleBuckets) {
   histogram->Record(first_duration);
   histogram->Record(second_duration);
   histogram->Record(second_duration);
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, Stopwatch) {
@@ -154,7 +160,7 @@ TEST(HistogramImplTest, Stopwatch) {
   auto histogram = tally::HistogramImpl::New(buckets);
   auto stopwatch = histogram->Start();
   stopwatch.Stop();
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
 }
 
 TEST(HistogramImplTest, RecordStopwatch) {
@@ -171,5 +177,311 @@ TEST(HistogramImplTest, RecordStopwatch) {
 
   auto histogram = tally::HistogramImpl::New(buckets);
   histogram->RecordStopwatch(std::chrono::steady_clock::now());
-  histogram->Report(name, tags, reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordValueIntoCatchAllBucket) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 10, 10, 9.0,
+                                          std::numeric_limits<double>::max(),
+                                          2));
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  histogram->Record(9.0);
+  histogram->Record(100.0);
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, ValueIsReset) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 2, 10, 1.0, 2.0, 1))
+      .Times(2);
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  histogram->Record(1.5);
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+  histogram->Record(1.5);
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordValueOnEveryBound) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::ExponentialValues(0.1, 1.3, 50);
+  std::vector<double> bounds(buckets.begin(), buckets.end());
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  // A value equal to a bound belongs to the bucket which that bound is the
+  // lower bound of.
+  for (std::size_t i = 0; i < bounds.size(); i++) {
+    auto const upper_bound = i + 1 == bounds.size()
+                                 ? std::numeric_limits<double>::max()
+                                 : bounds[i + 1];
+    EXPECT_CALL(*reporter.get(),
+                ReportHistogramValueSamples(name, tags, i + 1, 50, bounds[i],
+                                            upper_bound, 1));
+  }
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  for (auto const bound : bounds) {
+    histogram->Record(bound);
+  }
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordDurationOnEveryBound) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::ExponentialDurations(
+      std::chrono::microseconds(10), 3, 30);
+  std::vector<double> bounds(buckets.begin(), buckets.end());
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  // Each duration equal to a bound and each duration just below a bound must
+  // fall either side of it.
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples(
+                  name, tags, 0, 30, std::chrono::nanoseconds(0),
+                  std::chrono::nanoseconds(10000), 1));
+  for (std::size_t i = 0; i < bounds.size(); i++) {
+    auto const lower_bound =
+        std::chrono::nanoseconds(static_cast<int64_t>(bounds[i]));
+    auto const upper_bound =
+        i + 1 == bounds.size()
+            ? std::chrono::nanoseconds(std::numeric_limits<int64_t>::max())
+            : std::chrono::nanoseconds(static_cast<int64_t>(bounds[i + 1]));
+    auto const samples = i + 1 == bounds.size() ? 1 : 2;
+    EXPECT_CALL(*reporter.get(),
+                ReportHistogramDurationSamples(name, tags, i + 1, 30,
+                                               lower_bound, upper_bound,
+                                               samples));
+  }
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  for (auto const bound : bounds) {
+    auto const duration =
+        std::chrono::nanoseconds(static_cast<int64_t>(bound));
+    histogram->Record(duration);
+    histogram->Record(duration - std::chrono::nanoseconds(1));
+  }
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordValueWithCustomBuckets) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::CustomValues({1.0, 2.5, 10.0});
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 0, 3,
+                                          std::numeric_limits<double>::min(),
+                                          1.0, 1));
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 2, 3, 2.5, 10.0, 2));
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 3, 3, 10.0,
+                                          std::numeric_limits<double>::max(),
+                                          1));
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  histogram->Record(0.5);
+  histogram->Record(2.5);
+  histogram->Record(9.0);
+  histogram->Record(10.0);
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordManyValues) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  std::vector<double> values({1.5, 4.5, 1.2, 100.0, 1.9});
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 2, 10, 1.0, 2.0, 3));
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 5, 10, 4.0, 5.0, 1));
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 10, 10, 9.0,
+                                          std::numeric_limits<double>::max(),
+                                          1));
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  histogram->RecordMany(values.data(), values.size());
+  histogram->RecordMany(values.data(), 0);
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordManyDurations) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::ExponentialDurations(
+      std::chrono::nanoseconds(1000), 2, 10);
+  std::vector<std::chrono::nanoseconds> durations(
+      {std::chrono::nanoseconds(3000), std::chrono::nanoseconds(1500),
+       std::chrono::nanoseconds(1500)});
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples(
+                  name, tags, 1, 10, std::chrono::nanoseconds(1000),
+                  std::chrono::nanoseconds(2000), 2));
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples(
+                  name, tags, 2, 10, std::chrono::nanoseconds(2000),
+                  std::chrono::nanoseconds(4000), 1));
+
+  // Batches recorded by one thread into differently sized histograms must not
+  // interfere with each other.
+  auto histogram = tally::HistogramImpl::New(buckets);
+  auto other = tally::HistogramImpl::New(
+      tally::Buckets::LinearDurations(std::chrono::nanoseconds(0),
+                                      std::chrono::nanoseconds(1), 100));
+  other->RecordMany(durations.data(), durations.size());
+  histogram->RecordMany(durations.data(), durations.size());
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, ShardedRecordFromMultipleThreads) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  auto const num_threads = 16;
+  auto const records = 1000;
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 2, 10, 1.0, 2.0,
+                                          num_threads * records));
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramValueSamples(name, tags, 5, 10, 4.0, 5.0,
+                                          num_threads * 2));
+
+  auto histogram = tally::HistogramImpl::New(buckets, nullptr, 4);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < num_threads; i++) {
+    threads.push_back(std::thread([&histogram]() {
+      for (auto j = 0; j < records; j++) {
+        histogram->Record(1.5);
+      }
+      std::vector<double> values({4.5, 4.5});
+      histogram->RecordMany(values.data(), values.size());
+    }));
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(HistogramImplTest, RecordDurationWithLogLinearBuckets) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LogLinearDurations(
+      2, std::chrono::nanoseconds(1000));
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples(
+                  name, tags, 9, buckets.size(), std::chrono::nanoseconds(10),
+                  std::chrono::nanoseconds(12), 2));
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  histogram->Record(std::chrono::nanoseconds(10));
+  histogram->Record(std::chrono::nanoseconds(11));
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+// RecordDurationsAroundBounds records a duration one nanosecond either side of
+// and equal to each of the bounds of `buckets` into a histogram with `buckets`
+// and returns the number of samples reported for each bucket ID.
+std::map<uint64_t, uint64_t> RecordDurationsAroundBounds(
+    const tally::Buckets &buckets, const std::vector<int64_t> &bounds) {
+  std::map<uint64_t, uint64_t> samples;
+  std::shared_ptr<MockStatsReporter> reporter(new MockStatsReporter());
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples(testing::_, testing::_,
+                                             testing::_, testing::_,
+                                             testing::_, testing::_,
+                                             testing::_))
+      .WillRepeatedly(testing::Invoke(
+          [&samples](const std::string &,
+                     const std::unordered_map<std::string, std::string> &,
+                     uint64_t bucket_id, uint64_t, std::chrono::nanoseconds,
+                     std::chrono::nanoseconds,
+                     uint64_t num) { samples[bucket_id] += num; }));
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  for (auto const bound : bounds) {
+    for (int64_t offset = -1; offset <= 1; offset++) {
+      histogram->Record(std::chrono::nanoseconds(bound + offset));
+    }
+  }
+  histogram->Report("foo", *tally::TagSet::Intern({}), reporter.get());
+  return samples;
+}
+
+TEST(HistogramImplTest, ClosedFormDurationIndicesMatchSearch) {
+  for (auto const &buckets :
+       {tally::Buckets::LinearDurations(std::chrono::nanoseconds(1000),
+                                        std::chrono::nanoseconds(333), 500),
+        tally::Buckets::ExponentialDurations(std::chrono::nanoseconds(3), 3,
+                                             38)}) {
+    // Custom bounds are searched rather than estimated in closed form.
+    std::vector<int64_t> bounds;
+    std::vector<std::chrono::nanoseconds> durations;
+    for (auto const bound : buckets) {
+      durations.push_back(tally::HistogramBucket::ToNanoseconds(bound));
+      bounds.push_back(durations.back().count());
+    }
+    auto const custom = tally::Buckets::CustomDurations(durations);
+
+    EXPECT_EQ(RecordDurationsAroundBounds(custom, bounds),
+              RecordDurationsAroundBounds(buckets, bounds));
+  }
+}
+
+// RecordingHistogram implements only the methods of the Histogram interface
+// which have no default.
+class RecordingHistogram : public tally::Histogram {
+ public:
+  void Record(double value) noexcept { values.push_back(value); }
+
+  void Record(std::chrono::nanoseconds value) noexcept {
+    durations.push_back(value);
+  }
+
+  tally::Stopwatch Start() noexcept {
+    return tally::Stopwatch(std::chrono::steady_clock::now(), nullptr);
+  }
+
+  std::vector<double> values;
+  std::vector<std::chrono::nanoseconds> durations;
+};
+
+TEST(HistogramImplTest, DefaultRecordManyRecordsEachValue) {
+  RecordingHistogram histogram;
+  std::vector<double> values({1.0, 2.0});
+  std::vector<std::chrono::nanoseconds> durations(
+      {std::chrono::nanoseconds(3), std::chrono::nanoseconds(4)});
+  histogram.RecordMany(values.data(), values.size());
+  histogram.RecordMany(durations.data(), durations.size());
+
+  EXPECT_EQ(values, histogram.values);
+  EXPECT_EQ(durations, histogram.durations);
 }
@@ -0,0 +1,79 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/lap_stopwatch.h"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+#include "mock_stats_reporter.h"
+#include "tally/src/histogram_impl.h"
+#include "tally/src/timer_impl.h"
+
+TEST(LapStopwatchTest, RecordsEachPhase) {
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportTimer("parse", tags, testing::_)).Times(1);
+  EXPECT_CALL(*reporter, ReportTimer("send", tags, testing::_)).Times(1);
+  EXPECT_CALL(*reporter,
+              ReportHistogramDurationSamples(
+                  "lookup", tags, 2, 2, std::chrono::nanoseconds(1000000),
+                  std::chrono::nanoseconds(std::numeric_limits<int64_t>::max()),
+                  1));
+
+  auto parse =
+      tally::TimerImpl::New("parse", tally::TagSet::Intern(tags), reporter);
+  auto lookup = tally::HistogramImpl::New(tally::Buckets::LinearDurations(
+      std::chrono::nanoseconds(0), std::chrono::nanoseconds(1000000), 2));
+  auto send =
+      tally::TimerImpl::New("send", tally::TagSet::Intern(tags), reporter);
+
+  tally::LapStopwatch stopwatch;
+  stopwatch.Lap(*parse);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  auto const lookup_duration = stopwatch.Lap(*lookup);
+  stopwatch.Skip();
+  stopwatch.Lap(*send);
+  lookup->Report("lookup", tally::TagSet(tags), reporter.get());
+
+  EXPECT_GE(lookup_duration, std::chrono::milliseconds(2));
+}
+
+TEST(LapStopwatchTest, SkipBeginsNextPhase) {
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportTimer("foo", tags, testing::_)).Times(1);
+
+  auto timer =
+      tally::TimerImpl::New("foo", tally::TagSet::Intern(tags), reporter);
+  tally::LapStopwatch stopwatch;
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stopwatch.Skip();
+  EXPECT_LT(stopwatch.Lap(*timer), std::chrono::milliseconds(10));
+}
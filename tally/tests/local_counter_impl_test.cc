@@ -0,0 +1,119 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "mock_stats_reporter.h"
+#include "tally/src/counter_impl.h"
+#include "tally/src/local_counter_impl.h"
+
+TEST(LocalCounterImplTest, IncrementIsReported) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 4)).Times(1);
+
+  auto counter = std::make_shared<tally::CounterImpl>();
+  tally::LocalCounterImpl local(counter);
+  local.Inc();
+  local.Inc(3);
+  counter->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(LocalCounterImplTest, ValueIsReset) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 1)).Times(1);
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 2)).Times(1);
+
+  auto counter = std::make_shared<tally::CounterImpl>();
+  tally::LocalCounterImpl local(counter);
+  local.Inc(1);
+  counter->Report(name, tally::TagSet(tags), reporter.get());
+
+  local.Inc(2);
+  counter->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(LocalCounterImplTest, CombinedWithCounter) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 7)).Times(1);
+
+  auto counter = std::make_shared<tally::CounterImpl>();
+  tally::LocalCounterImpl first(counter);
+  tally::LocalCounterImpl second(counter);
+  counter->Inc(1);
+  first.Inc(2);
+  second.Inc(4);
+  counter->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(LocalCounterImplTest, IncrementsSurviveThreadExit) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  auto const num_threads = 8;
+  auto const increments = 1000;
+
+  EXPECT_CALL(*reporter.get(),
+              ReportCounter(name, tags, num_threads * increments))
+      .Times(1);
+
+  auto counter = std::make_shared<tally::CounterImpl>();
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < num_threads; i++) {
+    threads.push_back(std::thread([counter]() {
+      tally::LocalCounterImpl local(counter);
+      for (auto j = 0; j < increments; j++) {
+        local.Inc();
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  counter->Report(name, tally::TagSet(tags), reporter.get());
+}
+
+TEST(LocalCounterImplTest, DetachedValueIsNotReportedTwice) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportCounter(name, tags, 5)).Times(1);
+
+  auto counter = std::make_shared<tally::CounterImpl>();
+  {
+    tally::LocalCounterImpl local(counter);
+    local.Inc(5);
+    counter->Report(name, tally::TagSet(tags), reporter.get());
+  }
+  counter->Report(name, tally::TagSet(tags), reporter.get());
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/src/registry.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(RegistryTest, FindOrCreateCreatesOnce) {
+  tally::Registry<int> registry;
+  int created = 0;
+  auto create = [&created]() {
+    created++;
+    return std::make_shared<int>(created);
+  };
+
+  auto first = registry.FindOrCreate("foo", create);
+  EXPECT_EQ(first, registry.FindOrCreate("foo", create));
+  EXPECT_EQ(first, registry.Find("foo"));
+  EXPECT_EQ(1, created);
+  EXPECT_EQ(nullptr, registry.Find("fo"));
+  EXPECT_EQ(nullptr, registry.Find("foo2"));
+}
+
+TEST(RegistryTest, FindAfterGrowing) {
+  tally::Registry<int> registry;
+  for (int i = 0; i < 1000; i++) {
+    registry.FindOrCreate(std::to_string(i),
+                          [i]() { return std::make_shared<int>(i); });
+  }
+
+  int visited = 0;
+  registry.ForEach(
+      [&visited](const std::string &name, const std::shared_ptr<int> &value) {
+        EXPECT_EQ(name, std::to_string(*value));
+        visited++;
+      });
+  EXPECT_EQ(1000, visited);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i, *registry.Find(std::to_string(i)));
+  }
+}
+
+TEST(RegistryTest, CreateThrows) {
+  tally::Registry<int> registry;
+  EXPECT_THROW(registry.FindOrCreate("foo",
+                                     []() -> std::shared_ptr<int> {
+                                       throw std::invalid_argument("foo");
+                                     }),
+               std::invalid_argument);
+  EXPECT_EQ(nullptr, registry.Find("foo"));
+}
+
+TEST(RegistryTest, ConcurrentFindOrCreate) {
+  tally::Registry<int> registry;
+  std::atomic<int> created(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&registry, &created]() {
+      for (int i = 0; i < 500; i++) {
+        auto const value =
+            registry.FindOrCreate(std::to_string(i), [&created, i]() {
+              created++;
+              return std::make_shared<int>(i);
+            });
+        EXPECT_EQ(i, *value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(500, created.load());
+}
+
+TEST(RegistryTest, ForEachVisitsQualifiedNames) {
+  tally::Registry<int> registry(
+      [](const std::string &name) { return "prefix." + name; });
+  registry.FindOrCreate("foo", []() { return std::make_shared<int>(1); });
+
+  int visited = 0;
+  registry.ForEach(
+      [&visited](const std::string &name, const std::shared_ptr<int> &value) {
+        EXPECT_EQ("prefix.foo", name);
+        EXPECT_EQ(1, *value);
+        visited++;
+      });
+  EXPECT_EQ(1, visited);
+  EXPECT_NE(nullptr, registry.Find("foo"));
+  EXPECT_EQ(nullptr, registry.Find("prefix.foo"));
+}
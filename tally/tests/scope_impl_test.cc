@@ -19,6 +19,7 @@
 // THE SOFTWARE.
 
 #include <chrono>
+#include <stdexcept>
 #include <thread>
 
 #include "gtest/gtest.h"
@@ -26,6 +27,7 @@
 #include "mock_stats_reporter.h"
 #include "tally/buckets.h"
 #include "tally/scope_builder.h"
+#include "tally/src/capable_of.h"
 #include "tally/src/scope_impl.h"
 
 class MockCapabilites : public tally::Capabilities {
@@ -34,6 +36,47 @@ class MockCapabilites : public tally::Capabilities {
   MOCK_CONST_METHOD0(Tagging, bool());
 };
 
+// ForwardingScope implements only the methods of the Scope interface which
+// have no default, by forwarding them to another Scope.
+class ForwardingScope : public tally::Scope {
+ public:
+  explicit ForwardingScope(std::shared_ptr<tally::Scope> scope)
+      : scope_(scope) {}
+
+  std::shared_ptr<tally::Counter> Counter(const std::string &name) noexcept {
+    return scope_->Counter(name);
+  }
+
+  std::shared_ptr<tally::Gauge> Gauge(const std::string &name) noexcept {
+    return scope_->Gauge(name);
+  }
+
+  std::shared_ptr<tally::Timer> Timer(const std::string &name) noexcept {
+    return scope_->Timer(name);
+  }
+
+  std::shared_ptr<tally::Histogram> Histogram(
+      const std::string &name, const tally::Buckets &buckets) noexcept {
+    return scope_->Histogram(name, buckets);
+  }
+
+  std::shared_ptr<tally::Scope> SubScope(const std::string &name) noexcept {
+    return scope_->SubScope(name);
+  }
+
+  std::shared_ptr<tally::Scope> Tagged(
+      const std::unordered_map<std::string, std::string> &tags) noexcept {
+    return scope_->Tagged(tags);
+  }
+
+  std::unique_ptr<tally::Capabilities> Capabilities() noexcept {
+    return scope_->Capabilities();
+  }
+
+ private:
+  std::shared_ptr<tally::Scope> scope_;
+};
+
 TEST(ScopeImplTest, GetOrCreateCounter) {
   auto scope = tally::ScopeBuilder().Build();
   auto counter = scope->Counter("foo");
@@ -41,6 +84,198 @@ TEST(ScopeImplTest, GetOrCreateCounter) {
   EXPECT_NE(counter, scope->Counter("bar"));
 }
 
+TEST(ScopeImplTest, LookupByCString) {
+  auto scope = tally::ScopeBuilder().Build();
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  std::string const name("foo");
+
+  EXPECT_EQ(scope->Counter(name), scope->Counter(name.c_str()));
+  EXPECT_EQ(scope->Gauge(name.c_str()), scope->Gauge(name));
+  EXPECT_EQ(scope->Gauge(name.c_str(), tally::Gauge::Aggregation::Max),
+            scope->Gauge(name));
+  EXPECT_EQ(scope->Timer(name), scope->Timer(name.c_str()));
+  EXPECT_EQ(scope->Histogram(name.c_str(), buckets),
+            scope->Histogram(name, buckets));
+  EXPECT_NE(scope->Counter("fo"), scope->Counter(name));
+}
+
+TEST(ScopeImplTest, DefaultLookupByCString) {
+  std::shared_ptr<tally::Scope> scope = tally::ScopeBuilder().Build();
+  std::shared_ptr<tally::Scope> forwarding(new ForwardingScope(scope));
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  std::string const name("foo");
+
+  EXPECT_EQ(scope->Counter(name), forwarding->Counter(name.c_str()));
+  EXPECT_EQ(scope->Gauge(name), forwarding->Gauge(name.c_str()));
+  EXPECT_EQ(scope->Gauge(name),
+            forwarding->Gauge(name.c_str(), tally::Gauge::Aggregation::Max));
+  EXPECT_EQ(scope->Timer(name), forwarding->Timer(name.c_str()));
+  EXPECT_EQ(scope->Histogram(name, buckets),
+            forwarding->Histogram(name.c_str(), buckets));
+}
+
+TEST(ScopeImplTest, DefaultAggregatedGaugeIsGauge) {
+  std::shared_ptr<tally::Scope> scope = tally::ScopeBuilder().Build();
+  std::shared_ptr<tally::Scope> forwarding(new ForwardingScope(scope));
+
+  EXPECT_EQ(scope->Gauge("foo"),
+            forwarding->Gauge("foo", tally::Gauge::Aggregation::Last));
+  EXPECT_EQ(scope->Gauge("bar"),
+            forwarding->Gauge(std::string("bar"),
+                              tally::Gauge::Aggregation::Sum));
+}
+
+TEST(ScopeImplTest, DefaultCallbackGaugeIsDiscarded) {
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter, ReportGauge(testing::_, testing::_, testing::_))
+      .Times(0);
+
+  EXPECT_CALL(*reporter, Flush()).Times(testing::AtLeast(1));
+
+  auto invoked = false;
+  {
+    ForwardingScope forwarding(tally::ScopeBuilder()
+                                   .reporter(reporter)
+                                   .reporting_interval(std::chrono::seconds(1))
+                                   .Build());
+    forwarding.CallbackGauge("foo", [&invoked]() {
+      invoked = true;
+      return 1.0;
+    });
+  }
+  EXPECT_FALSE(invoked);
+}
+
+TEST(ScopeImplTest, DefaultSketchIsHistogram) {
+  std::shared_ptr<tally::Scope> scope = tally::ScopeBuilder().Build();
+  std::shared_ptr<tally::Scope> forwarding(new ForwardingScope(scope));
+
+  auto sketch = forwarding->Sketch("foo", tally::Buckets::Kind::Values, 0.01);
+  EXPECT_EQ(sketch,
+            scope->Histogram("foo", tally::Buckets::LinearValues(0, 1, 1)));
+  EXPECT_EQ(forwarding->Sketch("bar", tally::Buckets::Kind::Durations, 1e-9),
+            scope->Histogram("bar", tally::Buckets::LinearValues(0, 1, 1)));
+  EXPECT_THROW(forwarding->Sketch("baz", tally::Buckets::Kind::Values, 1.5),
+               std::invalid_argument);
+}
+
+TEST(ScopeImplTest, DefaultLocalCounterIncrementsCounter) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter, ReportCounter(name, tags, 3));
+
+  EXPECT_CALL(*reporter, Flush()).Times(testing::AtLeast(1));
+
+  // The scope reports its metrics when it is destroyed.
+  ForwardingScope forwarding(tally::ScopeBuilder()
+                                 .reporter(reporter)
+                                 .reporting_interval(std::chrono::seconds(1))
+                                 .Build());
+  auto counter = forwarding.LocalCounter(name);
+  counter->Inc();
+  counter->Inc(2);
+}
+
+TEST(ScopeImplTest, GetOrCreateStripedCounter) {
+  auto scope = tally::ScopeBuilder().counter_stripes(16).Build();
+  auto counter = scope->Counter("foo");
+  EXPECT_EQ(counter, scope->Counter("foo"));
+  EXPECT_NE(counter, scope->Counter("bar"));
+}
+
+TEST(ScopeImplTest, GetOrCreateShardedHistogram) {
+  auto scope = tally::ScopeBuilder().histogram_shards(8).Build();
+  auto buckets = tally::Buckets::LinearValues(0.0, 1.0, 10);
+  auto histogram = scope->Histogram("foo", buckets);
+  EXPECT_EQ(histogram, scope->Histogram("foo", buckets));
+  EXPECT_NE(histogram, scope->Histogram("bar", buckets));
+}
+
+TEST(ScopeImplTest, BufferedTimer) {
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportTimer(testing::_, testing::_, testing::_))
+      .Times(0);
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples("foo", testing::_, testing::_,
+                                             testing::_, testing::_,
+                                             testing::_, 2))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportCounter("foo.count", testing::_, 2))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportCounter("foo.sum", testing::_, 3000))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge("foo.min", testing::_, 1000))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge("foo.max", testing::_, 2000))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), Flush()).Times(testing::AtLeast(1));
+
+  auto scope = tally::ScopeBuilder()
+                   .reporter(reporter)
+                   .reporting_interval(std::chrono::seconds(1))
+                   .timer_mode(tally::Timer::Mode::Buffered)
+                   .Build();
+  auto timer = scope->Timer("foo");
+  EXPECT_EQ(timer, scope->Timer("foo"));
+  timer->Record(std::chrono::microseconds(1));
+  timer->Record(std::chrono::microseconds(2));
+}
+
+TEST(ScopeImplTest, TimerAggregatedForReporterCapabilities) {
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter, CapabilitiesProxy())
+      .WillOnce(testing::Return(new tally::CapableOf(true, true, true)));
+  EXPECT_CALL(*reporter.get(), ReportTimer(testing::_, testing::_, testing::_))
+      .Times(0);
+  EXPECT_CALL(*reporter.get(),
+              ReportHistogramDurationSamples("foo", testing::_, testing::_,
+                                             testing::_, testing::_,
+                                             testing::_, 1))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportCounter("foo.count", testing::_, 1))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportCounter("foo.sum", testing::_, 1000))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge("foo.min", testing::_, 1000))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), ReportGauge("foo.max", testing::_, 1000))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), Flush()).Times(testing::AtLeast(1));
+
+  auto scope = tally::ScopeBuilder()
+                   .reporter(reporter)
+                   .reporting_interval(std::chrono::seconds(1))
+                   .Build();
+  auto timer = scope->Timer("foo");
+  EXPECT_EQ(timer, scope->Timer("foo"));
+  timer->Record(std::chrono::microseconds(1));
+}
+
+TEST(ScopeImplTest, GetOrCreateSketch) {
+  auto scope = tally::ScopeBuilder().Build();
+  auto sketch = scope->Sketch("foo", tally::Buckets::Kind::Durations, 0.01);
+  EXPECT_EQ(sketch, scope->Sketch("foo", tally::Buckets::Kind::Values, 0.02));
+  EXPECT_NE(sketch,
+            scope->Sketch("bar", tally::Buckets::Kind::Durations, 0.01));
+  EXPECT_THROW(scope->Sketch("baz", tally::Buckets::Kind::Values, 1.5),
+               std::invalid_argument);
+}
+
+TEST(ScopeImplTest, LocalCounterSharesCounter) {
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportCounter("foo", testing::_, 3)).Times(1);
+  EXPECT_CALL(*reporter.get(), Flush()).Times(testing::AtLeast(1));
+
+  auto scope = tally::ScopeBuilder()
+                   .reporter(reporter)
+                   .reporting_interval(std::chrono::seconds(1))
+                   .Build();
+  auto local = scope->LocalCounter("foo");
+  local->Inc(2);
+  scope->Counter("foo")->Inc();
+}
+
 TEST(ScopeImplTest, GetOrCreateGauge) {
   auto scope = tally::ScopeBuilder().Build();
   auto gauge = scope->Gauge("foo");
@@ -48,6 +283,30 @@ TEST(ScopeImplTest, GetOrCreateGauge) {
   EXPECT_NE(gauge, scope->Gauge("bar"));
 }
 
+TEST(ScopeImplTest, GetOrCreateAggregatedGauge) {
+  auto scope = tally::ScopeBuilder().Build();
+  auto gauge = scope->Gauge("foo", tally::Gauge::Aggregation::Max);
+  EXPECT_EQ(gauge, scope->Gauge("foo", tally::Gauge::Aggregation::Max));
+  EXPECT_EQ(gauge, scope->Gauge("foo"));
+  EXPECT_NE(gauge, scope->Gauge("bar", tally::Gauge::Aggregation::Max));
+}
+
+TEST(ScopeImplTest, CallbackGauge) {
+  auto reporter = std::make_shared<MockStatsReporter>();
+  EXPECT_CALL(*reporter.get(), ReportGauge("foo", testing::_, 3.0))
+      .Times(testing::AtLeast(1));
+  EXPECT_CALL(*reporter.get(), Flush()).Times(testing::AtLeast(1));
+
+  auto scope = tally::ScopeBuilder()
+                   .reporter(reporter)
+                   .reporting_interval(std::chrono::seconds(1))
+                   .Build();
+  scope->CallbackGauge("foo", []() { return 3.0; });
+
+  // Registering a second callback with the same name keeps the first one.
+  scope->CallbackGauge("foo", []() { return 4.0; });
+}
+
 TEST(ScopeImplTest, GetOrCreateTimer) {
   auto scope = tally::ScopeBuilder().Build();
   auto timer = scope->Timer("foo");
@@ -77,6 +336,22 @@ TEST(ScopeImplTest, GetOrCreateTagged) {
   EXPECT_NE(sub_scope, scope->Tagged({{"b", "2"}}));
 }
 
+TEST(ScopeImplTest, GetOrCreateTaggedWithSameTags) {
+  auto scope = tally::ScopeBuilder().tags({{"a", "1"}}).Build();
+  auto sub_scope = scope->Tagged({{"a", "1"}, {"b", "2"}});
+  EXPECT_EQ(sub_scope, scope->Tagged({{"b", "2"}, {"a", "1"}}));
+  EXPECT_EQ(sub_scope, scope->Tagged({{"b", "2"}}));
+  EXPECT_NE(sub_scope, scope->Tagged({{"a", "2"}, {"b", "2"}}));
+  EXPECT_EQ(scope->Tagged({}), scope->Tagged({{"a", "1"}}));
+}
+
+TEST(ScopeImplTest, GetOrCreateSubScopeAndTagged) {
+  auto scope = tally::ScopeBuilder().Build();
+  auto sub_scope = scope->SubScope("foo")->Tagged({{"a", "1"}});
+  EXPECT_EQ(sub_scope, scope->SubScope("foo")->Tagged({{"a", "1"}}));
+  EXPECT_NE(sub_scope, scope->Tagged({{"a", "1"}})->SubScope("foo"));
+}
+
 TEST(ScopeImplTest, ValidReporterCapabilities) {
   auto capabilities = new MockCapabilites();
   auto reporter = std::make_shared<MockStatsReporter>();
@@ -90,6 +365,7 @@ TEST(ScopeImplTest, ValidReporterCapabilities) {
   auto actual_capabilities = scope->Capabilities();
   EXPECT_EQ(true, actual_capabilities->Reporting());
   EXPECT_EQ(true, actual_capabilities->Tagging());
+  EXPECT_EQ(false, actual_capabilities->AggregatedTimers());
 }
 
 TEST(ScopeImplTest, NoReporterCapabilities) {
@@ -97,6 +373,7 @@ TEST(ScopeImplTest, NoReporterCapabilities) {
   auto capabilities = scope->Capabilities();
   EXPECT_EQ(false, capabilities->Reporting());
   EXPECT_EQ(false, capabilities->Tagging());
+  EXPECT_EQ(false, capabilities->AggregatedTimers());
 }
 
 TEST(ScopeImplTest, Reporting) {
@@ -113,6 +390,8 @@ TEST(ScopeImplTest, Reporting) {
 
   auto reporter = std::make_shared<MockStatsReporter>();
 
+  EXPECT_CALL(*reporter, CapabilitiesProxy())
+      .WillOnce(testing::Return(new tally::CapableOf(true, true, false)));
   EXPECT_CALL(*reporter.get(), ReportCounter(expected_name, expected_tags, 1))
       .Times(1);
   EXPECT_CALL(*reporter.get(), ReportGauge(expected_name, expected_tags, 1.0))
@@ -144,3 +423,21 @@ TEST(ScopeImplTest, Reporting) {
   timer->Record(std::chrono::nanoseconds(1));
   histogram->Record(2.5);
 }
+
+TEST(ScopeImplTest, ReportingTaggedOverridesTags) {
+  std::unordered_map<std::string, std::string> expected_tags = {{"a", "2"},
+                                                                {"b", "1"}};
+
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter.get(), ReportCounter("foo", expected_tags, 1))
+      .Times(1);
+  EXPECT_CALL(*reporter.get(), Flush()).Times(testing::AtLeast(1));
+
+  auto scope = tally::ScopeBuilder()
+                   .tags({{"a", "1"}, {"b", "1"}})
+                   .reporter(reporter)
+                   .reporting_interval(std::chrono::seconds(1))
+                   .Build();
+  scope->Tagged({{"a", "2"}})->Counter("foo")->Inc();
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/scoped_stopwatch.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+#include "mock_stats_reporter.h"
+#include "tally/src/histogram_impl.h"
+#include "tally/src/timer_impl.h"
+
+TEST(ScopedStopwatchTest, RecordsIntoTimerWhenDestroyed) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportTimer(name, tags, testing::_)).Times(1);
+
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
+  { tally::ScopedStopwatch stopwatch(*timer); }
+}
+
+TEST(ScopedStopwatchTest, RecordsOnceWhenStopped) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportTimer(name, tags, testing::_)).Times(1);
+
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
+  {
+    tally::ScopedStopwatch stopwatch(*timer);
+    stopwatch.Stop();
+    stopwatch.Stop();
+  }
+}
+
+TEST(ScopedStopwatchTest, RecordsIntoHistogram) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LinearDurations(
+      std::chrono::nanoseconds(0), std::chrono::nanoseconds(1000000), 10);
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter,
+              ReportHistogramDurationSamples(
+                  name, tags, 1, 10, std::chrono::nanoseconds(0),
+                  std::chrono::nanoseconds(1000000), 1));
+
+  auto histogram = tally::HistogramImpl::New(buckets);
+  { tally::ScopedStopwatch stopwatch(*histogram); }
+  histogram->Report(name, tally::TagSet(tags), reporter.get());
+}
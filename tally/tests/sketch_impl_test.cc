@@ -0,0 +1,195 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "mock_stats_reporter.h"
+#include "tally/buckets.h"
+#include "tally/src/sketch_impl.h"
+
+TEST(SketchImplTest, ReportBucketsAndQuantiles) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             name, tags, testing::_, testing::_,
+                             testing::Le(10.0), testing::Ge(10.0), 2));
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             name, tags, testing::_, testing::_,
+                             testing::Le(1000.0), testing::Ge(1000.0), 1));
+  EXPECT_CALL(*reporter,
+              ReportGauge("foo.p50", tags, testing::DoubleNear(10.0, 0.1)));
+  EXPECT_CALL(*reporter,
+              ReportGauge("foo.p100", tags, testing::DoubleNear(1000.0, 10)));
+
+  auto sketch = tally::SketchImpl::New(name, tally::Buckets::Kind::Values,
+                                       0.01, 2048, {0.5, 1}, ".");
+  sketch->Record(10.0);
+  std::vector<double> values({10.0, 1000.0});
+  sketch->RecordMany(values.data(), values.size());
+  sketch->Report(tally::TagSet(tags), reporter.get());
+
+  // Nothing is reported for an interval without any values.
+  sketch->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(SketchImplTest, ReportDurations) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportHistogramDurationSamples(
+                             name, tags, testing::_, testing::_,
+                             testing::Le(std::chrono::nanoseconds(5000)),
+                             testing::Ge(std::chrono::nanoseconds(4999)), 1));
+  EXPECT_CALL(*reporter, ReportGauge(testing::_, tags, testing::_)).Times(6);
+
+  auto sketch =
+      tally::SketchImpl::New(name, tally::Buckets::Kind::Durations, 0.01, "_");
+  sketch->Record(std::chrono::nanoseconds(5000));
+  sketch->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(SketchImplTest, DefaultQuantileNames) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             testing::_, testing::_, testing::_, testing::_,
+                             testing::_, testing::_, testing::_));
+  for (auto const suffix : {"p50", "p75", "p90", "p95", "p99", "p999"}) {
+    EXPECT_CALL(*reporter,
+                ReportGauge(std::string("foo.") + suffix, tags, testing::_));
+  }
+
+  auto sketch =
+      tally::SketchImpl::New(name, tally::Buckets::Kind::Values, 0.01, ".");
+  sketch->Record(1.0);
+  sketch->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(SketchImplTest, ReportValuesOutsideWindow) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  // The window is anchored on the first value, so the others are recorded
+  // under the lock.
+  for (auto const value : {1.0, 1e12, 0.0, -5.0}) {
+    EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                               name, tags, testing::_, testing::_,
+                               testing::Le(value), testing::Ge(value), 1));
+  }
+  EXPECT_CALL(*reporter, ReportGauge(testing::_, tags, testing::_)).Times(6);
+
+  auto sketch =
+      tally::SketchImpl::New(name, tally::Buckets::Kind::Values, 0.01, ".");
+  sketch->Record(1.0);
+  std::vector<double> values({1e12, 0.0, -5.0});
+  sketch->RecordMany(values.data(), values.size());
+  sketch->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(SketchImplTest, WindowAnchoredOnOutlierIsRecentered) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  // Each interval's values are counted in the same buckets whether they are
+  // recorded in the window or under the lock.
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             name, tags, testing::_, testing::_,
+                             testing::Le(1e9), testing::Ge(1e9), 1))
+      .Times(3);
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             name, tags, testing::_, testing::_,
+                             testing::Le(10.0), testing::Ge(10.0), 99));
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             name, tags, testing::_, testing::_,
+                             testing::Le(10.0), testing::Ge(10.0), 100))
+      .Times(2);
+  EXPECT_CALL(*reporter,
+              ReportGauge("foo.p50", tags, testing::DoubleNear(10.0, 0.1)))
+      .Times(3);
+
+  auto sketch = tally::SketchImpl::New(name, tally::Buckets::Kind::Values,
+                                       0.01, 2048, {0.5}, ".");
+  sketch->Record(1e9);
+  for (auto i = 0; i < 99; i++) {
+    sketch->Record(10.0);
+  }
+  sketch->Report(tally::TagSet(tags), reporter.get());
+
+  for (auto interval = 0; interval < 2; interval++) {
+    for (auto i = 0; i < 100; i++) {
+      sketch->Record(10.0);
+    }
+    sketch->Record(1e9);
+    sketch->Report(tally::TagSet(tags), reporter.get());
+  }
+}
+
+TEST(SketchImplTest, RecordConcurrently) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  uint64_t samples = 0;
+  EXPECT_CALL(*reporter, ReportHistogramValueSamples(
+                             name, tags, testing::_, testing::_, testing::_,
+                             testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke(
+          [&samples](const std::string &,
+                     const std::unordered_map<std::string, std::string> &,
+                     uint64_t, uint64_t, double, double,
+                     uint64_t value) { samples += value; }));
+  EXPECT_CALL(*reporter, ReportGauge(testing::_, tags, testing::_))
+      .Times(testing::AnyNumber());
+
+  auto sketch =
+      tally::SketchImpl::New(name, tally::Buckets::Kind::Values, 0.01, ".");
+  std::vector<std::thread> recorders;
+  for (int i = 0; i < 2; i++) {
+    recorders.emplace_back([&sketch]() {
+      for (int j = 0; j < 10000; j++) {
+        sketch->Record(static_cast<double>(j % 100) - 10);
+      }
+    });
+  }
+  for (int i = 0; i < 100; i++) {
+    sketch->Report(tally::TagSet(tags), reporter.get());
+  }
+  for (auto &recorder : recorders) {
+    recorder.join();
+  }
+  sketch->Report(tally::TagSet(tags), reporter.get());
+
+  EXPECT_EQ(20000, samples);
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/suspendable_stopwatch.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+#include "mock_stats_reporter.h"
+#include "tally/src/histogram_impl.h"
+#include "tally/src/timer_impl.h"
+
+namespace {
+
+// Saves the duration a mock timer was reported with.
+ACTION_P(SaveDuration, duration) { *duration = arg2; }
+
+}  // namespace
+
+TEST(SuspendableStopwatchTest, ExcludesSuspendedTimeFromActiveTime) {
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  std::chrono::nanoseconds wall(0);
+  std::chrono::nanoseconds active(0);
+
+  EXPECT_CALL(*reporter, ReportTimer("wall", tags, testing::_))
+      .WillOnce(SaveDuration(&wall));
+  EXPECT_CALL(*reporter, ReportTimer("active", tags, testing::_))
+      .WillOnce(SaveDuration(&active));
+
+  auto wall_timer =
+      tally::TimerImpl::New("wall", tally::TagSet::Intern(tags), reporter);
+  auto active_timer =
+      tally::TimerImpl::New("active", tally::TagSet::Intern(tags), reporter);
+  {
+    tally::SuspendableStopwatch stopwatch(*wall_timer, *active_timer);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    stopwatch.Suspend();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stopwatch.Resume();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  EXPECT_GE(wall, std::chrono::milliseconds(60));
+  EXPECT_GE(active, std::chrono::milliseconds(10));
+  EXPECT_LE(active, wall - std::chrono::milliseconds(50));
+}
+
+TEST(SuspendableStopwatchTest, RecordsOnceWhenStoppedWhileSuspended) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::LinearDurations(
+      std::chrono::nanoseconds(0), std::chrono::nanoseconds(1000000), 10);
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter,
+              ReportHistogramDurationSamples(
+                  name, tags, 1, 10, std::chrono::nanoseconds(0),
+                  std::chrono::nanoseconds(1000000), 1))
+      .Times(2);
+
+  auto wall = tally::HistogramImpl::New(buckets);
+  auto active = tally::HistogramImpl::New(buckets);
+  {
+    tally::SuspendableStopwatch stopwatch(*wall, *active);
+    stopwatch.Suspend();
+    stopwatch.Suspend();
+    stopwatch.Stop();
+    stopwatch.Resume();
+    stopwatch.Stop();
+  }
+  wall->Report(name, tally::TagSet(tags), reporter.get());
+  active->Report(name, tally::TagSet(tags), reporter.get());
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 Uber Technologies, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tally/tag_set.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(TagSetTest, SortsTagsByName) {
+  tally::TagSet tags({{"c", "3"}, {"a", "1"}, {"b", "2"}});
+  std::vector<tally::TagSet::Tag> expected(
+      {{"a", "1"}, {"b", "2"}, {"c", "3"}});
+  EXPECT_EQ(expected,
+            std::vector<tally::TagSet::Tag>(tags.begin(), tags.end()));
+  EXPECT_EQ(3, tags.size());
+  EXPECT_FALSE(tags.empty());
+  EXPECT_TRUE(tally::TagSet({}).empty());
+}
+
+TEST(TagSetTest, EqualTagsHashEqually) {
+  tally::TagSet tags({{"a", "1"}, {"b", "2"}});
+  tally::TagSet same({{"b", "2"}, {"a", "1"}});
+  tally::TagSet other({{"a", "2"}, {"b", "1"}});
+  EXPECT_EQ(tags, same);
+  EXPECT_EQ(tags.hash(), same.hash());
+  EXPECT_NE(tags, other);
+  EXPECT_NE(tags.hash(), other.hash());
+  EXPECT_EQ(tags, tally::TagSet(tags));
+}
+
+TEST(TagSetTest, InternSharesEqualTags) {
+  auto tags = tally::TagSet::Intern({{"a", "1"}, {"b", "2"}});
+  EXPECT_EQ(tags, tally::TagSet::Intern({{"b", "2"}, {"a", "1"}}));
+  EXPECT_NE(tags, tally::TagSet::Intern({{"a", "1"}}));
+  EXPECT_EQ(tally::TagSet::Intern({}), tally::TagSet::Intern({}));
+}
+
+TEST(TagSetTest, InternAfterRelease) {
+  std::unordered_map<std::string, std::string> map({{"released", "1"}});
+  auto tags = tally::TagSet::Intern(map);
+  auto const hash = tags->hash();
+  tags.reset();
+
+  tags = tally::TagSet::Intern(map);
+  EXPECT_EQ(hash, tags->hash());
+  EXPECT_EQ(tags, tally::TagSet::Intern(map));
+}
+
+TEST(TagSetTest, InternConcurrently) {
+  std::vector<std::shared_ptr<const tally::TagSet>> interned(8);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < interned.size(); i++) {
+    threads.emplace_back([&interned, i]() {
+      for (int j = 0; j < 1000; j++) {
+        interned[i] = tally::TagSet::Intern({{"a", std::to_string(j % 10)}});
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto const &tags : interned) {
+    EXPECT_EQ(tally::TagSet::Intern({{"a", "9"}}), tags);
+  }
+}
+
+TEST(TagSetTest, MergeOverridesTags) {
+  auto tags = tally::TagSet::Intern({{"a", "1"}, {"c", "3"}});
+  auto merged = tags->Merge({{"b", "2"}, {"c", "4"}, {"d", "5"}});
+  EXPECT_EQ(
+      tally::TagSet::Intern({{"a", "1"}, {"b", "2"}, {"c", "4"}, {"d", "5"}}),
+      merged);
+  EXPECT_EQ(tags, tags->Merge({}));
+  EXPECT_EQ(tags, tags->Merge({{"a", "1"}}));
+}
+
+TEST(TagSetTest, AsMap) {
+  std::unordered_map<std::string, std::string> map({{"a", "1"}, {"b", "2"}});
+  auto tags = tally::TagSet::Intern(map);
+  EXPECT_EQ(map, tags->AsMap());
+  EXPECT_EQ(&tags->AsMap(), &tags->AsMap());
+}
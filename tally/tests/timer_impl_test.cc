@@ -19,6 +19,9 @@
 // THE SOFTWARE.
 
 #include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -33,7 +36,8 @@ TEST(TimerImplTest, RecordOnce) {
 
   EXPECT_CALL(*reporter, ReportTimer(name, tags, duration)).Times(1);
 
-  auto timer = tally::TimerImpl::New(name, tags, reporter);
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
   timer->Record(duration);
 }
 
@@ -47,7 +51,8 @@ TEST(TimerImplTest, RecordMultipleTimes) {
   EXPECT_CALL(*reporter, ReportTimer(name, tags, first_duration)).Times(1);
   EXPECT_CALL(*reporter, ReportTimer(name, tags, second_duration)).Times(1);
 
-  auto timer = tally::TimerImpl::New(name, tags, reporter);
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
   timer->Record(first_duration);
   timer->Record(second_duration);
 }
@@ -59,7 +64,8 @@ TEST(TimerImplTest, Stopwatch) {
 
   EXPECT_CALL(*reporter, ReportTimer(name, tags, testing::_)).Times(1);
 
-  auto timer = tally::TimerImpl::New(name, tags, reporter);
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
   auto stopwatch = timer->Start();
   stopwatch.Stop();
 }
@@ -71,6 +77,150 @@ TEST(TimerImplTest, RecordStopwatch) {
 
   EXPECT_CALL(*reporter, ReportTimer(name, tags, testing::_)).Times(1);
 
-  auto timer = tally::TimerImpl::New(name, tags, reporter);
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
   timer->RecordStopwatch(std::chrono::steady_clock::now());
 }
+
+TEST(TimerImplTest, RecordMany) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+  std::vector<std::chrono::nanoseconds> durations(
+      {std::chrono::nanoseconds(1), std::chrono::nanoseconds(2),
+       std::chrono::nanoseconds(1)});
+
+  EXPECT_CALL(*reporter, ReportTimer(name, tags, durations[0])).Times(2);
+  EXPECT_CALL(*reporter, ReportTimer(name, tags, durations[1])).Times(1);
+
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
+  timer->RecordMany(durations.data(), durations.size());
+}
+
+TEST(TimerImplTest, BufferedReport) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto buckets = tally::Buckets::ExponentialDurations(
+      std::chrono::nanoseconds(1000), 2, 10);
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportTimer(testing::_, testing::_, testing::_))
+      .Times(0);
+  EXPECT_CALL(*reporter, ReportHistogramDurationSamples(
+                             name, tags, 1, 10, std::chrono::nanoseconds(1000),
+                             std::chrono::nanoseconds(2000), 2));
+  EXPECT_CALL(*reporter, ReportHistogramDurationSamples(
+                             name, tags, 2, 10, std::chrono::nanoseconds(2000),
+                             std::chrono::nanoseconds(4000), 1));
+  EXPECT_CALL(*reporter, ReportCounter("foo.count", tags, 3));
+  EXPECT_CALL(*reporter, ReportCounter("foo.sum", tags, 6000));
+  EXPECT_CALL(*reporter, ReportGauge("foo.min", tags, 1500));
+  EXPECT_CALL(*reporter, ReportGauge("foo.max", tags, 3000));
+
+  auto timer = tally::TimerImpl::New(name, buckets, ".", 1, 1, nullptr);
+  timer->Record(std::chrono::nanoseconds(1500));
+  std::vector<std::chrono::nanoseconds> durations(
+      {std::chrono::nanoseconds(3000), std::chrono::nanoseconds(1500)});
+  timer->RecordMany(durations.data(), durations.size());
+  timer->Report(tally::TagSet(tags), reporter.get());
+
+  // Nothing is reported for an interval without any durations.
+  timer->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(TimerImplTest, SampledReportsReservoir) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  // Only as many durations as fit in the reservoir are reported, but the count
+  // and sum cover every duration.
+  EXPECT_CALL(*reporter, ReportTimer(name, tags, testing::_)).Times(4);
+  EXPECT_CALL(*reporter, ReportCounter("foo.count", tags, 100));
+  EXPECT_CALL(*reporter, ReportCounter("foo.sum", tags, 5050));
+  EXPECT_CALL(*reporter, ReportGauge("foo.sample_rate", tags, 0.04));
+
+  auto timer = tally::TimerImpl::New(name, 4, ".", 1, nullptr);
+  std::vector<std::chrono::nanoseconds> durations;
+  for (int64_t i = 1; i <= 50; i++) {
+    timer->Record(std::chrono::nanoseconds(i));
+    durations.push_back(std::chrono::nanoseconds(50 + i));
+  }
+  timer->RecordMany(durations.data(), durations.size());
+  timer->Report(tally::TagSet(tags), reporter.get());
+
+  // Nothing is reported for an interval without any durations.
+  timer->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(TimerImplTest, SampledReportsEveryDurationBelowReservoirSize) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter,
+              ReportTimer(name, tags, std::chrono::nanoseconds(10)));
+  EXPECT_CALL(*reporter,
+              ReportTimer(name, tags, std::chrono::nanoseconds(20)));
+  EXPECT_CALL(*reporter, ReportCounter("foo.count", tags, 2));
+  EXPECT_CALL(*reporter, ReportCounter("foo.sum", tags, 30));
+  EXPECT_CALL(*reporter, ReportGauge("foo.sample_rate", tags, 1.0));
+
+  auto timer = tally::TimerImpl::New(name, 4, ".", 1, nullptr);
+  timer->Record(std::chrono::nanoseconds(10));
+  timer->Record(std::chrono::nanoseconds(20));
+  timer->Report(tally::TagSet(tags), reporter.get());
+}
+
+TEST(TimerImplTest, SampledReportsOnlyRecordedDurations) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  int64_t count = 0;
+  EXPECT_CALL(*reporter,
+              ReportTimer(name, tags, std::chrono::nanoseconds(7)))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(*reporter, ReportCounter("foo.count", tags, testing::_))
+      .WillRepeatedly(testing::Invoke(
+          [&count](const std::string &,
+                   const std::unordered_map<std::string, std::string> &,
+                   int64_t value) { count += value; }));
+  EXPECT_CALL(*reporter, ReportCounter("foo.sum", tags, testing::_))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(*reporter, ReportGauge("foo.sample_rate", tags, testing::_))
+      .Times(testing::AnyNumber());
+
+  auto timer = tally::TimerImpl::New(name, 4, ".", 1, nullptr);
+  std::vector<std::thread> recorders;
+  for (int i = 0; i < 2; i++) {
+    recorders.emplace_back([&timer]() {
+      for (int j = 0; j < 10000; j++) {
+        timer->Record(std::chrono::nanoseconds(7));
+      }
+    });
+  }
+  for (int i = 0; i < 100; i++) {
+    timer->Report(tally::TagSet(tags), reporter.get());
+  }
+  for (auto &recorder : recorders) {
+    recorder.join();
+  }
+  timer->Report(tally::TagSet(tags), reporter.get());
+
+  EXPECT_EQ(20000, count);
+}
+
+TEST(TimerImplTest, ImmediateReportIsNoop) {
+  std::string name("foo");
+  std::unordered_map<std::string, std::string> tags({});
+  auto reporter = std::make_shared<MockStatsReporter>();
+
+  EXPECT_CALL(*reporter, ReportTimer(name, tags, testing::_)).Times(1);
+
+  auto timer =
+      tally::TimerImpl::New(name, tally::TagSet::Intern(tags), reporter);
+  timer->Record(std::chrono::nanoseconds(1));
+  timer->Report(tally::TagSet(tags), reporter.get());
+}